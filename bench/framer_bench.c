@@ -0,0 +1,107 @@
+#define _POSIX_C_SOURCE 200809L
+#include "proto.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// priepustnosť textového framera: prúd príkazov sa kŕmi po kúskoch rôznej dĺžky,
+// rovnako ako ho server skladá v c->in
+#define STREAM_CMDS 2000000
+#define IN_CAP 16384
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char* build_stream(int cmds, int *out_len) {
+    int cap = cmds * 24;
+    char *buf = (char*)malloc((size_t)cap);
+    int len = 0;
+    if (!buf) return NULL;
+
+    for (int i = 0; i < cmds; i++) {
+        Message m;
+        memset(&m, 0, sizeof(m));
+        // prevažne MOVE ako od botov, občas niečo iné
+        if (i % 64 == 0) {
+            m.type = MSG_ROOM_LIST;
+        } else if (i % 64 == 1) {
+            m.type = MSG_PLAYER_NAME;
+            snprintf(m.data, sizeof(m.data), "bot%d", i % 1000);
+        } else {
+            m.type = MSG_MOVE;
+            m.player_id = i % 4;
+            m.direction = (Direction)(i % 4);
+        }
+        len += proto_format_cmd_text(&m, buf + len, cap - len);
+    }
+
+    *out_len = len;
+    return buf;
+}
+
+// jeden prechod prúdom po kúskoch chunk bajtov, vráti počet príkazov
+static long run(const char *stream, int len, int chunk, long *checksum) {
+    static char in[IN_CAP];
+    int in_len = 0, off = 0;
+    long cmds = 0;
+
+    while (off < len) {
+        int n = len - off < chunk ? len - off : chunk;
+        if (n > IN_CAP - in_len) n = IN_CAP - in_len;
+        memcpy(in + in_len, stream + off, (size_t)n);
+        in_len += n;
+        off += n;
+
+        int pos = 0, used;
+        while ((used = proto_text_frame(in + pos, in_len - pos)) > 0) {
+            Message m;
+            if (proto_parse_cmd_text(in + pos, used, &m) == 0) {
+                cmds++;
+                *checksum += m.type + m.player_id + m.direction;
+            }
+            pos += used;
+        }
+        if (pos > 0) {
+            in_len -= pos;
+            memmove(in, in + pos, (size_t)in_len);
+        }
+    }
+    return cmds;
+}
+
+int main(int argc, char **argv) {
+    int cmds = (argc > 1) ? atoi(argv[1]) : STREAM_CMDS;
+    if (cmds <= 0) cmds = STREAM_CMDS;
+
+    int len;
+    char *stream = build_stream(cmds, &len);
+    if (!stream) return 1;
+
+    printf("prúd: %d príkazov, %d bajtov\n", cmds, len);
+    printf("%8s %12s %12s %10s\n", "kúsok", "príkazov/s", "MB/s", "ns/príkaz");
+
+    // 1 = každý bajt zvlášť (najhoršie delenie), 1460 ~ jeden TCP segment
+    int chunks[] = { 1, 7, 64, 1460, 16384 };
+    for (int i = 0; i < (int)(sizeof(chunks) / sizeof(chunks[0])); i++) {
+        long checksum = 0;
+        double t0 = now_sec();
+        long got = run(stream, len, chunks[i], &checksum);
+        double dt = now_sec() - t0;
+
+        if (got != cmds) {
+            fprintf(stderr, "CHYBA: kúsok %d dal %ld príkazov z %d\n", chunks[i], got, cmds);
+            free(stream);
+            return 1;
+        }
+        printf("%8d %12.0f %12.1f %10.1f   (kontrola %ld)\n",
+               chunks[i], got / dt, len / dt / 1e6, dt * 1e9 / got, checksum);
+    }
+
+    free(stream);
+    return 0;
+}
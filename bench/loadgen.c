@@ -0,0 +1,697 @@
+#define _POSIX_C_SOURCE 200809L
+#include "proto.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+// záťažový generátor: N botov sa pripojí ako src/client.c (HELLO, NEW_GAME/ROOM_JOIN, PLAYER,
+// MOVE, QUIT), hýbe sa náhodne alebo podľa skriptu a meria príchod stavov, prenos a oneskorenia;
+// s -c boti priebežne odchádzajú a vracajú sa a kontroluje sa, že hráčov v stave nepribúda
+
+#define BOT_IN_SIZE 65536   // počiatočný prijímací buffer, rastie až po najväčší rámec
+#define MAX_EVENTS 256
+#define MIN_RATE_LIFE 0.1   // sekúnd, kratší život bota do prenosu na bota nejde
+
+typedef enum {
+    BOT_CONNECTING,
+    BOT_HELLO,      // čaká na odpoveď na HELLO
+    BOT_WAIT_ROOM,  // čaká, kým vedúci skupiny založí miestnosť
+    BOT_JOINING,    // PLAYER odoslaný, čaká na ASSIGN
+    BOT_PLAYING,
+    BOT_DONE
+} bot_phase_t;
+
+typedef struct {
+    int fd;
+    bot_phase_t phase;
+    int binary;
+    int group;
+    int leader;
+    int failed;
+
+    Direction dir;
+    int script_pos;
+    unsigned int input_seq;
+    double next_move;
+    double next_churn;
+    int churns;
+
+    double t_start;
+    double t_connected;
+    double t_player;
+    double t_assigned;
+    double last_state;
+    double period;      // perióda ticku miestnosti (z kľúčového stavu)
+
+    unsigned long rx_bytes;
+    unsigned long states;
+
+    uint8_t *in;
+    int in_len;
+    int in_cap;
+} bot_t;
+
+typedef struct {
+    const char *host;
+    int port;
+    int bots;
+    double duration;
+    double move_rate;
+    const char *script;     // NULL = náhodný pohyb
+    int group;
+    int width;
+    int height;
+    int tick_rate;
+    TickMode tick_mode;
+    int text;
+    double ramp;            // pripojení za sekundu, 0 = všetky naraz
+    double churn;           // priemerné sekundy hry medzi odchodmi bota, 0 = bez odchodov
+} loadgen_opts_t;
+
+// rastúce pole vzoriek v milisekundách
+typedef struct {
+    double *v;
+    int n;
+    int cap;
+} samples_t;
+
+static loadgen_opts_t O;
+static bot_t *bots;
+static int *group_room;     // id miestnosti skupiny, 0 = ešte nie je
+static int epfd;
+static samples_t s_connect, s_assign, s_gap, s_jitter, s_rate;
+static unsigned long n_full, n_room_err, n_send_drop, n_conn_fail, n_closed, n_churn;
+static int max_players_seen;    // najväčší num_players v prijatom stave
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void sample_add(samples_t *s, double v) {
+    if (s->n == s->cap) {
+        int cap = s->cap ? s->cap * 2 : 1024;
+        double *nv = (double*)realloc(s->v, (size_t)cap * sizeof(double));
+        if (!nv) return;
+        s->v = nv;
+        s->cap = cap;
+    }
+    s->v[s->n++] = v;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const samples_t *s, double q) {
+    if (s->n == 0) return 0;
+    int i = (int)(q * (s->n - 1) + 0.5);
+    return s->v[i];
+}
+
+static void print_row(const char *name, samples_t *s, const char *unit) {
+    if (s->n == 0) {
+        printf("%-18s %10s\n", name, "-");
+        return;
+    }
+    qsort(s->v, (size_t)s->n, sizeof(double), cmp_double);
+    printf("%-18s %10.2f %10.2f %10.2f %10.2f %10.2f   %s, vzoriek %d\n", name,
+           percentile(s, 0.5), percentile(s, 0.9), percentile(s, 0.99), percentile(s, 0.999),
+           s->v[s->n - 1], unit, s->n);
+}
+
+// ---------- ODOSIELANIE ----------
+
+static int bot_send(bot_t *b, const Message *m) {
+    char buf[512];
+    int len;
+    if (b->binary) {
+        wbuf_t w;
+        wbuf_init(&w, buf, (int)sizeof(buf));
+        len = (proto_encode_cmd(m, &w) == 0) ? w.len : -1;
+    } else {
+        len = proto_format_cmd_text(m, buf, (int)sizeof(buf));
+    }
+    if (len <= 0) return -1;
+
+    // príkazy sú malé; plný socket znamená, že server nečíta, a ťah sa zahodí
+    ssize_t n = send(b->fd, buf, (size_t)len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n == len) return 0;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        n_send_drop++;
+        return 0;
+    }
+    return -1;
+}
+
+static void bot_fail(bot_t *b) {
+    if (b->phase == BOT_DONE) return;
+    if (b->fd >= 0) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, b->fd, NULL);
+        close(b->fd);
+    }
+    b->fd = -1;
+    b->phase = BOT_DONE;
+    b->failed = 1;
+}
+
+static void bot_send_player(bot_t *b, int idx, double now) {
+    Message m;
+    memset(&m, 0, sizeof(m));
+    m.type = MSG_PLAYER_NAME;
+    snprintf(m.data, sizeof(m.data), "bot%d", idx);
+    if (bot_send(b, &m) < 0) {
+        bot_fail(b);
+        return;
+    }
+    b->t_player = now;
+    b->phase = BOT_JOINING;
+}
+
+// vedúci skupiny zakladá miestnosť, ostatní (aj vedúci po návrate) čakajú na jej id
+static void bot_enter(bot_t *b, int idx, double now) {
+    Message m;
+    memset(&m, 0, sizeof(m));
+
+    if (b->leader && group_room[b->group] == 0) {
+        m.type = MSG_NEW_GAME;
+        m.args[0] = MODE_STANDARD;
+        m.args[1] = WORLD_NO_OBSTACLES;
+        m.args[2] = 0;
+        m.args[3] = O.width;
+        m.args[4] = O.height;
+        m.args[5] = O.tick_rate;
+        m.args[6] = O.tick_mode;
+    } else {
+        int room = group_room[b->group];
+        if (room == 0) {
+            b->phase = BOT_WAIT_ROOM;
+            return;
+        }
+        m.type = MSG_JOIN_GAME;
+        m.game_id = room;
+    }
+
+    if (bot_send(b, &m) < 0) {
+        bot_fail(b);
+        return;
+    }
+    bot_send_player(b, idx, now);
+}
+
+static void group_ready(int group, int room, double now) {
+    group_room[group] = room;
+    for (int i = 0; i < O.bots; i++) {
+        bot_t *b = &bots[i];
+        if (b->group == group && b->phase == BOT_WAIT_ROOM) bot_enter(b, i, now);
+    }
+}
+
+static Direction script_dir(char c) {
+    switch (c) {
+        case 'W': case 'w': return UP;
+        case 'S': case 's': return DOWN;
+        case 'A': case 'a': return LEFT;
+        case 'D': case 'd': return RIGHT;
+        default:            return NONE;
+    }
+}
+
+static int opposite(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+static void bot_move(bot_t *b) {
+    Direction d = b->dir;
+    if (O.script) {
+        Direction s = script_dir(O.script[b->script_pos]);
+        b->script_pos = O.script[b->script_pos + 1] ? b->script_pos + 1 : 0;
+        if (s != NONE) d = s;
+    } else if (rand() % 4 == 0) {
+        d = (Direction)(rand() % 4);
+    }
+    // otočka do seba by bota hneď zabila, tak ako to bráni aj klient; rovnako posiela len zmenu smeru
+    if (d == b->dir || opposite(d, b->dir)) return;
+    b->dir = d;
+
+    Message m;
+    memset(&m, 0, sizeof(m));
+    m.type = MSG_MOVE;
+    m.direction = b->dir;
+    m.input_seq = ++b->input_seq;
+    if (bot_send(b, &m) < 0) bot_fail(b);
+}
+
+// ---------- PRÍJEM ----------
+
+static void note_players(int n) {
+    if (n > max_players_seen) max_players_seen = n;
+}
+
+static void bot_state(bot_t *b, double now) {
+    if (b->last_state > 0) {
+        double gap = now - b->last_state;
+        sample_add(&s_gap, gap * 1e3);
+        double period = b->period > 0 ? b->period : 1.0 / O.tick_rate;
+        double j = gap - period;
+        sample_add(&s_jitter, (j < 0 ? -j : j) * 1e3);
+    }
+    b->last_state = now;
+    b->states++;
+}
+
+static void bot_message(bot_t *b, MessageType type, int value, double now) {
+    switch (type) {
+        case MSG_ROOM:
+            if (b->leader && group_room[b->group] == 0) group_ready(b->group, value, now);
+            break;
+        case MSG_ASSIGN:
+            if (b->phase == BOT_JOINING) {
+                b->t_assigned = now;
+                sample_add(&s_assign, (now - b->t_player) * 1e3);
+                b->phase = BOT_PLAYING;
+                b->next_move = now;
+                // odchody rozhodené, aby sa boti nestriedali naraz
+                if (O.churn > 0) b->next_churn = now + O.churn * (0.5 + (double)rand() / RAND_MAX);
+            }
+            break;
+        case MSG_SERVER_FULL:
+            n_full++;
+            bot_fail(b);
+            break;
+        case MSG_ROOM_ERR:
+            n_room_err++;
+            bot_fail(b);
+            break;
+        default:
+            break;
+    }
+}
+
+static int bot_binary_frames(bot_t *b, double now) {
+    static GameState g;
+    int pos = 0;
+    MessageType type;
+    int plen, rc;
+
+    while ((rc = proto_frame_peek(b->in + pos, b->in_len - pos, &type, &plen)) > 0) {
+        const uint8_t *payload = b->in + pos + PROTO_HEADER_SIZE;
+        if (type == MSG_GAME_STATE) {
+            uint32_t seq;
+            if (proto_decode_state(payload, plen, &g, &seq) == 0 && g.tick_rate > 0) {
+                b->period = 1.0 / g.tick_rate;
+                note_players(g.num_players);
+            }
+            bot_state(b, now);
+        } else if (type == MSG_VIEW_STATE) {
+            uint32_t seq;
+            ViewRect v;
+            if (proto_decode_view(payload, plen, &g, &seq, &v) == 0 && g.tick_rate > 0) {
+                b->period = 1.0 / g.tick_rate;
+                note_players(g.num_players);
+            }
+            bot_state(b, now);
+        } else if (type == MSG_STATE_DELTA) {
+            bot_state(b, now);
+        } else {
+            rbuf_t r;
+            rbuf_init(&r, payload, plen);
+            int value = (plen >= 4) ? (int)r_u32(&r) : 0;
+            bot_message(b, type, value, now);
+        }
+        pos += PROTO_HEADER_SIZE + plen;
+        if (b->phase == BOT_DONE) return 0;
+    }
+    if (rc < 0) return -1;
+    return pos;
+}
+
+static int bot_text_lines(bot_t *b, int idx, double now) {
+    int pos = 0, used;
+    while ((used = proto_text_frame((const char*)b->in + pos, b->in_len - pos)) > 0) {
+        const char *line = (const char*)b->in + pos;
+        pos += used;
+
+        if (b->phase == BOT_HELLO) {
+            // po HELLO ide server binárne, zvyšok buffra už sú rámce
+            b->binary = (strncmp(line, "HELLO|", 6) == 0);
+            bot_enter(b, idx, now);
+            if (b->binary) return pos;
+            continue;
+        }
+
+        if (strncmp(line, "STATE|", 6) == 0) {
+            int id, w, h, np;
+            if (sscanf(line, "STATE|%d|%d|%d|%d|", &id, &w, &h, &np) == 4) note_players(np);
+            bot_state(b, now);
+        }
+        else if (strncmp(line, "ROOM|", 5) == 0)    bot_message(b, MSG_ROOM, atoi(line + 5), now);
+        else if (strncmp(line, "ASSIGN|", 7) == 0)  bot_message(b, MSG_ASSIGN, atoi(line + 7), now);
+        else if (strncmp(line, "SERVER_FULL", 11) == 0) bot_message(b, MSG_SERVER_FULL, 0, now);
+        else if (strncmp(line, "ROOM_ERR", 8) == 0) bot_message(b, MSG_ROOM_ERR, 0, now);
+        if (b->phase == BOT_DONE) return 0;
+    }
+    return pos;
+}
+
+// plný buffer bez celého rámca sa zdvojnásobí; -1 = rámec väčší ako protokol dovoľuje
+static int bot_in_grow(bot_t *b) {
+    int cap = b->in_cap ? b->in_cap * 2 : BOT_IN_SIZE;
+    if (cap > 2 * PROTO_MAX_FRAME) return -1;
+    uint8_t *in = (uint8_t*)realloc(b->in, (size_t)cap);
+    if (!in) return -1;
+    b->in = in;
+    b->in_cap = cap;
+    return 0;
+}
+
+static void bot_readable(bot_t *b, int idx, double now) {
+    for (;;) {
+        if (b->in_len == b->in_cap && bot_in_grow(b) < 0) {
+            bot_fail(b);
+            return;
+        }
+        ssize_t n = recv(b->fd, b->in + b->in_len, (size_t)(b->in_cap - b->in_len), 0);
+        if (n == 0) {
+            n_closed++;
+            bot_fail(b);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) bot_fail(b);
+            return;
+        }
+        b->in_len += (int)n;
+        b->rx_bytes += (unsigned long)n;
+
+        int used;
+        do {
+            int was_binary = b->binary && b->phase != BOT_HELLO;
+            used = was_binary ? bot_binary_frames(b, now) : bot_text_lines(b, idx, now);
+            if (b->phase == BOT_DONE) return;
+            if (used < 0) {
+                bot_fail(b);
+                return;
+            }
+            if (used > 0) {
+                b->in_len -= used;
+                memmove(b->in, b->in + used, (size_t)b->in_len);
+            }
+            // po HELLO sa zvyšok buffra číta už ako binárne rámce
+        } while (used > 0 && b->in_len > 0);
+    }
+}
+
+// ---------- SPOJENIA ----------
+
+static int bot_connect(bot_t *b, int idx, double now) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)O.port);
+    if (inet_pton(AF_INET, O.host, &addr.sin_addr) != 1) return -1;
+
+    b->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (b->fd < 0) return -1;
+    fcntl(b->fd, F_SETFL, fcntl(b->fd, F_GETFL, 0) | O_NONBLOCK);
+    int one = 1;
+    setsockopt(b->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    b->t_start = now;
+    b->phase = BOT_CONNECTING;
+    if (connect(b->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(b->fd);
+        b->fd = -1;
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u32 = (uint32_t)idx;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, b->fd, &ev);
+}
+
+static void bot_connected(bot_t *b, int idx, double now) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(b->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+        n_conn_fail++;
+        bot_fail(b);
+        return;
+    }
+
+    // prenos na bota sa počíta od prvého pripojenia, aj keď sa medzitým (-c) pripájal znova
+    if (b->t_connected == 0) b->t_connected = now;
+    sample_add(&s_connect, (now - b->t_start) * 1e3);
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)idx;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, b->fd, &ev);
+
+    if (O.text) {
+        bot_enter(b, idx, now);
+        return;
+    }
+
+    char hello[32];
+    int n = snprintf(hello, sizeof(hello), "HELLO|%d\n", PROTO_VERSION);
+    if (send(b->fd, hello, (size_t)n, MSG_NOSIGNAL) != n) {
+        bot_fail(b);
+        return;
+    }
+    b->phase = BOT_HELLO;
+}
+
+// -c: striedavo QUIT s novým PLAYER na tom istom spojení (server znova použije slot hráča)
+// a odpojenie s novým pripojením (slot odídeného hráča dostane ďalší, kto príde)
+static void bot_churn(bot_t *b, int idx, double now) {
+    n_churn++;
+    if (b->churns++ % 2 == 0) {
+        Message m;
+        memset(&m, 0, sizeof(m));
+        m.type = MSG_QUIT;
+        if (bot_send(b, &m) < 0) {
+            bot_fail(b);
+            return;
+        }
+        bot_send_player(b, idx, now);
+        return;
+    }
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, b->fd, NULL);
+    close(b->fd);
+    b->fd = -1;
+    b->in_len = 0;
+    b->binary = 0;
+    b->last_state = 0;
+    if (bot_connect(b, idx, now) < 0) {
+        n_conn_fail++;
+        bot_fail(b);
+    }
+}
+
+static void raise_fd_limit(int need) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) < 0) return;
+    if (rl.rlim_cur >= (rlim_t)need) return;
+    rl.rlim_cur = (rl.rlim_max == RLIM_INFINITY || rl.rlim_max >= (rlim_t)need) ? (rlim_t)need : rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+}
+
+// ---------- HLAVNÝ CYKLUS ----------
+
+static int parse_options(int argc, char **argv) {
+    O.host = "127.0.0.1";
+    O.bots = 100;
+    O.duration = 10;
+    O.move_rate = 5;
+    O.script = NULL;
+    O.group = DEFAULT_MAX_PLAYERS;
+    O.width = DEFAULT_MAP_SIZE;
+    O.height = DEFAULT_MAP_SIZE;
+    O.tick_rate = FPS;
+    O.tick_mode = TICK_SEQUENTIAL;
+    O.text = 0;
+    O.ramp = 0;
+    O.churn = 0;
+
+    if (argc < 2 || (O.port = atoi(argv[1])) <= 0) goto usage;
+
+    optind = 2;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:r:m:g:s:t:R:H:c:TP")) != -1) {
+        switch (opt) {
+            case 'n': O.bots = atoi(optarg); break;
+            case 'd': O.duration = atof(optarg); break;
+            case 'r': O.move_rate = atof(optarg); break;
+            case 'm': O.script = strcmp(optarg, "random") == 0 ? NULL : optarg; break;
+            case 'g': O.group = atoi(optarg); break;
+            case 's': O.width = O.height = atoi(optarg); break;
+            case 't': O.tick_rate = atoi(optarg); break;
+            case 'R': O.ramp = atof(optarg); break;
+            case 'H': O.host = optarg; break;
+            case 'c': O.churn = atof(optarg); break;
+            case 'T': O.text = 1; break;
+            case 'P': O.tick_mode = TICK_TWO_PHASE; break;
+            default: goto usage;
+        }
+    }
+
+    if (O.bots < 1 || O.duration <= 0 || O.group < 1 || O.tick_rate < MIN_TICK_RATE ||
+        O.width < MIN_MAP_SIZE || O.width > MAX_MAP_SIZE) goto usage;
+    return 0;
+
+usage:
+    fprintf(stderr, "Použitie: %s <port> [-n botov] [-d sekúnd] [-r ťahov_za_sekundu] [-m random|WASD...]\n"
+                    "          [-g botov_na_miestnosť] [-s rozmer_mapy] [-t tickov_za_sekundu]\n"
+                    "          [-R pripojení_za_sekundu] [-H adresa] [-T (textový protokol)]"
+                    " [-P (dvojfázový tick)] [-c sekúnd_medzi_odchodmi]\n", argv[0]);
+    return -1;
+}
+
+int main(int argc, char **argv) {
+    if (parse_options(argc, argv) < 0) return 1;
+
+    srand((unsigned)time(NULL));
+    raise_fd_limit(O.bots + 16);
+
+    int groups = (O.bots + O.group - 1) / O.group;
+    bots = (bot_t*)calloc((size_t)O.bots, sizeof(bot_t));
+    group_room = (int*)calloc((size_t)groups, sizeof(int));
+    epfd = epoll_create1(0);
+    if (!bots || !group_room || epfd < 0) {
+        perror("loadgen");
+        return 1;
+    }
+
+    for (int i = 0; i < O.bots; i++) {
+        bots[i].fd = -1;
+        bots[i].group = i / O.group;
+        bots[i].leader = (i % O.group == 0);
+        bots[i].dir = RIGHT;
+        bots[i].phase = BOT_CONNECTING;
+    }
+
+    printf("loadgen: %d botov na %s:%d, %d na miestnosť, %.1f ťahov/s, %s, %s protokol\n",
+           O.bots, O.host, O.port, O.group, O.move_rate, O.script ? O.script : "náhodný pohyb",
+           O.text ? "textový" : "binárny");
+    fflush(stdout);
+
+    double t0 = now_sec(), end = t0 + O.duration;
+    double move_period = O.move_rate > 0 ? 1.0 / O.move_rate : 0;
+    int started = 0;
+    struct epoll_event events[MAX_EVENTS];
+
+    for (;;) {
+        double now = now_sec();
+        if (now >= end) break;
+
+        // rozbeh pripojení
+        int want = O.ramp > 0 ? (int)((now - t0) * O.ramp) + 1 : O.bots;
+        if (want > O.bots) want = O.bots;
+        while (started < want) {
+            if (bot_connect(&bots[started], started, now) < 0) {
+                n_conn_fail++;
+                bot_fail(&bots[started]);
+            }
+            started++;
+        }
+
+        // ťahy, ktorých čas nastal, a najbližší termín
+        double wake = end;
+        if (started < O.bots) wake = t0 + started / O.ramp;
+        for (int i = 0; i < started; i++) {
+            bot_t *b = &bots[i];
+            if (b->phase == BOT_PLAYING && O.churn > 0) {
+                if (b->next_churn <= now) bot_churn(b, i, now);
+                else if (b->next_churn < wake) wake = b->next_churn;
+            }
+            if (b->phase != BOT_PLAYING || move_period <= 0) continue;
+            if (b->next_move <= now) {
+                bot_move(b);
+                b->next_move += move_period;
+                if (b->next_move < now) b->next_move = now + move_period;
+            }
+            if (b->phase == BOT_PLAYING && b->next_move < wake) wake = b->next_move;
+        }
+
+        int timeout = (int)((wake - now_sec()) * 1e3);
+        if (timeout < 0) timeout = 0;
+        int n = epoll_wait(epfd, events, MAX_EVENTS, timeout);
+        if (n < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+
+        now = now_sec();
+        for (int i = 0; i < n; i++) {
+            int idx = (int)events[i].data.u32;
+            bot_t *b = &bots[idx];
+            if (b->phase == BOT_DONE) continue;
+
+            if (b->phase == BOT_CONNECTING) {
+                if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) bot_connected(b, idx, now);
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) bot_readable(b, idx, now);
+        }
+    }
+
+    // koniec: QUIT a štatistiky
+    double elapsed = now_sec() - t0;
+    int playing = 0, connected = 0, failed = 0;
+    unsigned long rx_total = 0, states_total = 0;
+    for (int i = 0; i < O.bots; i++) {
+        bot_t *b = &bots[i];
+        if (b->t_connected > 0) connected++;
+        if (b->failed) failed++;
+        rx_total += b->rx_bytes;
+        states_total += b->states;
+
+        // prenos len pre botov, ktorí dostali aspoň jeden stav; odmietnutý bot by odpoveďou
+        // za pár mikrosekúnd života ukázal obrovský B/s
+        if (b->t_connected > 0 && b->states > 0) {
+            double live = (b->fd >= 0 ? now_sec() : b->last_state) - b->t_connected;
+            if (live >= MIN_RATE_LIFE) sample_add(&s_rate, b->rx_bytes / live);
+        }
+        if (b->phase == BOT_PLAYING) {
+            playing++;
+            Message m;
+            memset(&m, 0, sizeof(m));
+            m.type = MSG_QUIT;
+            bot_send(b, &m);
+        }
+        if (b->fd >= 0) close(b->fd);
+    }
+
+    printf("\nbotov %d: pripojených %d, v hre %d, zlyhaných %d (plná miestnosť %lu, chyba miestnosti %lu,"
+           " pripojenie %lu, zavreté serverom %lu), zahodených ťahov %lu\n",
+           O.bots, connected, playing, failed, n_full, n_room_err, n_conn_fail, n_closed, n_send_drop);
+    printf("trvanie %.1f s, prijaté %.2f MB/s, stavov %.0f/s\n",
+           elapsed, rx_total / elapsed / 1e6, states_total / elapsed);
+    // sloty odídených hráčov sa používajú znova, v miestnosti nesmie byť viac slotov ako botov
+    int slots_grow = (O.churn > 0 && max_players_seen > O.group);
+    printf("hráčov v stave najviac %d (botov na miestnosť %d), odchodov a návratov %lu%s\n\n",
+           max_players_seen, O.group, n_churn, slots_grow ? " - SLOTY HRÁČOV RASTÚ" : "");
+
+    printf("%-18s %10s %10s %10s %10s %10s\n", "", "p50", "p90", "p99", "p99.9", "max");
+    print_row("pripojenie", &s_connect, "ms");
+    print_row("PLAYER -> ASSIGN", &s_assign, "ms");
+    print_row("medzera stavov", &s_gap, "ms");
+    print_row("jitter stavov", &s_jitter, "ms");
+    print_row("prenos na bota", &s_rate, "B/s");
+
+    close(epfd);
+    for (int i = 0; i < O.bots; i++) free(bots[i].in);
+    free(bots);
+    free(group_room);
+    return slots_grow ? 2 : 0;
+}
@@ -0,0 +1,119 @@
+#define _POSIX_C_SOURCE 200809L
+#include "render.h"
+#include "snake.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// skladanie snímku klienta pre predvolenú mapu: celé prekreslenie a bežný snímok,
+// kde sa pohne niekoľko hadíkov; výstup ide do /dev/null
+#define MAP DEFAULT_MAP_SIZE
+#define FRAMES 20000
+#define ROWS 60
+#define COLS 100
+#define CELL_W 2
+#define SNAKES 4
+#define SNAKE_LEN 12
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char world[MAP][MAP];
+
+static void world_init(void) {
+    memset(world, ' ', sizeof(world));
+    for (int i = 0; i < MAP; i++) {
+        world[i][0] = world[i][MAP - 1] = CELL_OBSTACLE;
+        world[0][i] = world[MAP - 1][i] = CELL_OBSTACLE;
+    }
+}
+
+// hadíky idú po riadkoch dokola, každý snímok o bunku ďalej
+static void world_step(int frame) {
+    const int inner = MAP - 2;
+    const int area = inner * inner;
+
+    for (int k = 0; k < SNAKES; k++) {
+        int base = k * (area / SNAKES) + frame;
+        int tail = (base - SNAKE_LEN + area) % area;
+        int body = (base - 1 + area) % area;
+        int head = base % area;
+        world[1 + tail / inner][1 + tail % inner] = ' ';
+        world[1 + body / inner][1 + body % inner] = CELL_BODY;
+        world[1 + head / inner][1 + head % inner] = CELL_HEAD;
+    }
+    int fruit = (frame * 7) % area;
+    world[1 + fruit / inner][1 + fruit % inner] = CELL_FRUIT;
+}
+
+static void compose(screen_t *s, int frame) {
+    screen_begin(s);
+    int row = 0;
+    screen_printf(s, row++, 0, "Max hráčov: %d", 10);
+    for (int k = 0; k < SNAKES; k++) {
+        screen_printf(s, row++, 0, "Meno: bot%d | ID: %d | Skóre: %d", k, k, frame / 10 + k);
+    }
+    row = screen_draw_map(s, row + 1, &world[0][0], MAP, MAP, MAP, CELL_W);
+    screen_printf(s, row++, 0, "Tvoje body: %d | Čas: %d s", frame / 10, frame / 5);
+}
+
+static int run(int fd, int frames, int full, int colors, long *bytes) {
+    screen_t s;
+    if (screen_init(&s, ROWS, COLS) < 0) return -1;
+    screen_set_colors(&s, colors);
+
+    for (int f = 0; f < frames; f++) {
+        world_step(f);
+        compose(&s, f);
+        if (full) screen_invalidate(&s);
+        int n = screen_flush(&s, fd);
+        if (n < 0) {
+            screen_free(&s);
+            return -1;
+        }
+        *bytes += n;
+    }
+    screen_free(&s);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int frames = (argc > 1) ? atoi(argv[1]) : FRAMES;
+    if (frames <= 0) frames = FRAMES;
+
+    int fd = open("/dev/null", O_WRONLY);
+    if (fd < 0) {
+        perror("open /dev/null");
+        return 1;
+    }
+
+    printf("mapa %dx%d, obrazovka %dx%d, %d snímkov\n", MAP, MAP, ROWS, COLS, frames);
+    printf("%-10s %-6s %12s %12s %10s\n", "snímok", "farby", "snímkov/s", "bajtov/sn.", "us/snímok");
+
+    for (int full = 1; full >= 0; full--) {
+        for (int colors = 0; colors <= 1; colors++) {
+            long bytes = 0;
+            world_init();
+            double t0 = now_sec();
+            if (run(fd, frames, full, colors, &bytes) < 0) {
+                fprintf(stderr, "CHYBA: zápis snímku zlyhal\n");
+                close(fd);
+                return 1;
+            }
+            double dt = now_sec() - t0;
+            printf("%-10s %-6s %12.0f %12ld %10.2f\n",
+                   full ? "celý" : "rozdiel", colors ? "áno" : "nie",
+                   frames / dt, bytes / frames, dt * 1e6 / frames);
+        }
+    }
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#define _POSIX_C_SOURCE 200809L
+#include "journal.h"
+
+#include <time.h>
+
+// replay žurnálu zo servera (-J): hra sa odsimuluje bez siete tak rýchlo, ako to procesor
+// dovolí, a každý odtlačok stavu v žurnáli sa porovná s odsimulovaným; zachytené hry tak
+// slúžia na zopakovanie chyby aj ako záťaž pre benchmark ticku
+
+static GameState game;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint8_t* read_file(const char *path, int *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    int cap = 65536, n = 0;
+    uint8_t *buf = (uint8_t*)malloc((size_t)cap);
+    while (buf) {
+        size_t k = fread(buf + n, 1, (size_t)(cap - n), f);
+        n += (int)k;
+        if (n < cap) break;
+        uint8_t *nb = (cap <= (1 << 30)) ? (uint8_t*)realloc(buf, (size_t)cap * 2) : NULL;
+        if (!nb) {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        buf = nb;
+        cap *= 2;
+    }
+    fclose(f);
+    *len = n;
+    return buf;
+}
+
+typedef struct {
+    long records;
+    long ticks;
+    long joins;
+    long hashes;
+    long mismatches;
+    unsigned int first_bad_tick;
+    double seconds;
+    int truncated;
+    int damaged;
+} replay_result_t;
+
+static int replay(const uint8_t *buf, int len, pool_t *pool, int verbose, replay_result_t *res) {
+    journal_reader_t jr;
+    journal_config_t cfg;
+    if (journal_reader_init(&jr, buf, len, &cfg) < 0) return -1;
+
+    memset(res, 0, sizeof(*res));
+    if (init_game(&game, cfg.width, cfg.height, cfg.mode, cfg.time_limit, cfg.world_type, cfg.seed) < 0) return -1;
+    game.id = cfg.room_id;
+    game.tick_rate = cfg.tick_rate;
+    game.tick_mode = cfg.tick_mode;
+
+    double t0 = now_sec();
+    journal_rec_t rec;
+    int rc;
+    while ((rc = journal_read(&jr, &rec)) > 0) {
+        res->records++;
+        if (rec.type == JREC_HASH) {
+            res->hashes++;
+            uint64_t h = game_hash(&game);
+            if (h != rec.hash || game.tick != rec.tick) {
+                if (res->mismatches++ == 0) res->first_bad_tick = rec.tick;
+                if (verbose) {
+                    printf("tick %u: odtlačok %016llx, v žurnáli %016llx (tick %u)\n", game.tick,
+                           (unsigned long long)h, (unsigned long long)rec.hash, rec.tick);
+                }
+            }
+            continue;
+        }
+        if (rec.type == JREC_TICK) res->ticks++;
+        if (rec.type == JREC_JOIN) res->joins++;
+        journal_apply(&game, &rec, pool);
+    }
+    res->seconds = now_sec() - t0;
+    res->truncated = jr.truncated;
+    res->damaged = (rc < 0);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Použitie: %s <žurnál> [opakovaní] [vlákien_dvojfázového_ticku]\n", argv[0]);
+        return 1;
+    }
+    int repeats = (argc > 2) ? atoi(argv[2]) : 1;
+    int threads = (argc > 3) ? atoi(argv[3]) : 0;
+    if (repeats < 1) repeats = 1;
+    game_log = 0;
+
+    int len;
+    uint8_t *buf = read_file(argv[1], &len);
+    if (!buf) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    journal_reader_t jr;
+    journal_config_t cfg;
+    if (journal_reader_init(&jr, buf, len, &cfg) < 0) {
+        fprintf(stderr, "%s: nie je žurnál verzie %d\n", argv[1], JOURNAL_VERSION);
+        return 1;
+    }
+    printf("žurnál %s: %d B, miestnosť %d, seed %016llx, %dx%d, režim %d, svet %d, %d tickov/s, %s\n",
+           argv[1], len, cfg.room_id, (unsigned long long)cfg.seed, cfg.width, cfg.height, cfg.mode,
+           cfg.world_type, cfg.tick_rate, cfg.tick_mode == TICK_TWO_PHASE ? "dvojfázový tick" : "tick po poradí");
+
+    pool_t *pool = threads > 0 ? pool_create(threads) : NULL;
+    int bad = 0;
+    double best = 0;
+    replay_result_t res;
+    for (int i = 0; i < repeats; i++) {
+        // podrobne len prvý beh, ďalšie sú meranie
+        if (replay(buf, len, pool, i == 0, &res) < 0) {
+            fprintf(stderr, "%s: hru sa nepodarilo založiť\n", argv[1]);
+            return 1;
+        }
+        if (res.mismatches) bad = 1;
+        if (i == 0 || res.seconds < best) best = res.seconds;
+    }
+    pool_free(pool);
+
+    double game_sec = cfg.tick_rate > 0 ? (double)res.ticks / cfg.tick_rate : 0;
+    printf("záznamov %ld, tickov %ld (%.1f s hry), hráčov %ld, koniec tick %u\n", res.records, res.ticks,
+           game_sec, res.joins, game.tick);
+    if (res.truncated) printf("posledný záznam je orezaný (server skončil uprostred zápisu)\n");
+    if (res.damaged) printf("neznámy typ záznamu, replay skončil predčasne\n");
+    printf("najlepší z %d behov: %.3f ms, %.0f tickov/s, %.0fx rýchlejšie ako naživo\n", repeats, best * 1e3,
+           best > 0 ? res.ticks / best : 0, best > 0 ? game_sec / best : 0);
+    if (bad) {
+        printf("ODTLAČKY NESEDIA: %ld z %ld, prvý pri ticku %u\n", res.mismatches, res.hashes, res.first_bad_tick);
+        return 2;
+    }
+    printf("odtlačky sedia: %ld z %ld\n", res.hashes, res.hashes);
+    return 0;
+}
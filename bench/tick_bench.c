@@ -0,0 +1,164 @@
+#define _POSIX_C_SOURCE 200809L
+#include "game.h"
+
+#include <stdint.h>
+#include <time.h>
+
+// cena ticku simulácie bez siete: skriptované hry cez rozmery mapy, počty hráčov a dĺžky hadíkov;
+// pohyb aj ovocie idú z pevného seedu, takže dva behy (aj dve verzie kódu) hrajú rovnakú hru;
+// druhá tabuľka je dvojfázový tick na veľkej mape s rôznym počtom vlákien (kontrola musí sedieť)
+#define TICKS 200000
+#define TWO_PHASE_TICKS_DIV 10  // z počtu tickov, hadíkov je tam oveľa viac
+#define SEED 12345u
+// keď prežije menej ako polovica hadíkov, hra sa založí znova (mimo meraného času)
+#define MIN_ALIVE_RATIO 2
+
+static GameState game;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// vlastný generátor pre ťahy, nezávislý od generátora hry
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// každá hra v behu má iný seed, ale ich poradie je pevné
+static int start_game(int size, int players, int len, TickMode tick_mode, uint64_t seed) {
+    if (init_game(&game, size, size, MODE_STANDARD, 0, WORLD_NO_OBSTACLES, seed) < 0) return -1;
+    game.tick_mode = tick_mode;
+    for (int i = 0; i < players; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "bot%d", i);
+        if (spawn_snake(&game, i, name, len) < 0) return -1;
+    }
+    return 0;
+}
+
+static int alive_count(void) {
+    int n = 0;
+    for (int i = 0; i < game.num_players; i++) n += player_alive(&game, i);
+    return n;
+}
+
+// každý živý hadík občas zatočí doľava alebo doprava, nikdy nie do seba
+static void script_moves(void) {
+    static const Direction left[]  = { LEFT, RIGHT, DOWN, UP };
+    static const Direction right[] = { RIGHT, LEFT, UP, DOWN };
+
+    for (int i = 0; i < game.num_players; i++) {
+        if (!player_alive(&game, i)) continue;
+        uint32_t r = rng_next() & 7;
+        if (r == 0) player_set_next_dir(&game, i, left[player_dir(&game, i)]);
+        else if (r == 1) player_set_next_dir(&game, i, right[player_dir(&game, i)]);
+    }
+}
+
+typedef struct {
+    double ns_tick;
+    double ns_move;
+    long games;
+    size_t memory;          // najviac bajtov, ktoré hra držala
+    unsigned long checksum;
+} result_t;
+
+static int run(int size, int players, int len, TickMode tick_mode, pool_t *pool, long ticks, result_t *res) {
+    rng_state = SEED;
+    if (start_game(size, players, len, tick_mode, SEED) < 0) return -1;
+
+    double spent = 0;
+    long moves = 0, done = 0;
+    unsigned long checksum = 0;
+    res->games = 1;
+    res->memory = 0;
+
+    while (done < ticks) {
+        // dávka tickov do reštartu hry; skript ťahov je v meraní, je lacný a rovnaký pre každú verziu
+        double t0 = now_sec();
+        while (done < ticks && alive_count() * MIN_ALIVE_RATIO >= players) {
+            moves += alive_count();
+            script_moves();
+            game_tick_pool(&game, pool);
+            dirty_clear(&game);
+            done++;
+        }
+        spent += now_sec() - t0;
+
+        for (int i = 0; i < game.num_players; i++) checksum += (unsigned long)game.players[i].score;
+        if (game_memory(&game) > res->memory) res->memory = game_memory(&game);
+        if (done < ticks) {
+            if (start_game(size, players, len, tick_mode, SEED + (uint64_t)res->games) < 0) return -1;
+            res->games++;
+        }
+    }
+
+    res->ns_tick = spent * 1e9 / (double)done;
+    res->ns_move = moves ? spent * 1e9 / (double)moves : 0;
+    res->checksum = checksum + game.tick;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long ticks = (argc > 1) ? atol(argv[1]) : TICKS;
+    if (ticks <= 0) ticks = TICKS;
+    game_log = 0;
+
+    int sizes[] = { MIN_MAP_SIZE, DEFAULT_MAP_SIZE, MAX_MAP_SIZE };
+    int players[] = { 1, 4, 10, 100 };
+    int lens[] = { INITIAL_SNAKE_LEN, MIN_MAP_SIZE };
+
+    printf("GameState: %zu B, %ld tickov na konfiguráciu, seed %u\n", sizeof(GameState), ticks, SEED);
+    printf("%6s %6s %6s %12s %12s %8s %10s %12s\n", "mapa", "hráči", "dĺžka", "ns/tick", "ns/ťah", "hier", "KB",
+           "kontrola");
+
+    for (int si = 0; si < (int)(sizeof(sizes) / sizeof(sizes[0])); si++) {
+        for (int pi = 0; pi < (int)(sizeof(players) / sizeof(players[0])); pi++) {
+            for (int li = 0; li < (int)(sizeof(lens) / sizeof(lens[0])); li++) {
+                result_t r;
+                if (run(sizes[si], players[pi], lens[li], TICK_SEQUENTIAL, NULL, ticks, &r) < 0) {
+                    printf("%3dx%-3d %6d %6d %12s\n", sizes[si], sizes[si], players[pi], lens[li], "nezmestí sa");
+                    continue;
+                }
+                printf("%3dx%-3d %6d %6d %12.1f %12.1f %8ld %10.1f %12lu\n", sizes[si], sizes[si], players[pi],
+                       lens[li], r.ns_tick, r.ns_move, r.games, (double)r.memory / 1024, r.checksum);
+            }
+        }
+    }
+
+    // dvojfázový tick: 0 vlákien = fáza zámerov priamo v hlavnom vlákne
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads[] = { 0, 1, 2, 4, (cores > 4) ? (int)cores - 1 : 0 };
+    int big_players[] = { 100, 400, 1000 };
+    long big_ticks = ticks / TWO_PHASE_TICKS_DIV;
+    if (big_ticks < 1) big_ticks = 1;
+
+    printf("\ndvojfázový tick, %ld tickov, jadier: %ld\n", big_ticks, cores);
+    printf("%6s %6s %8s %12s %12s %8s %12s\n", "mapa", "hráči", "vlákna", "ns/tick", "ns/ťah", "hier", "kontrola");
+
+    for (int pi = 0; pi < (int)(sizeof(big_players) / sizeof(big_players[0])); pi++) {
+        result_t r;
+        if (run(MAX_MAP_SIZE, big_players[pi], INITIAL_SNAKE_LEN, TICK_SEQUENTIAL, NULL, big_ticks, &r) == 0) {
+            printf("%3dx%-3d %6d %8s %12.1f %12.1f %8ld %12lu\n", MAX_MAP_SIZE, MAX_MAP_SIZE, big_players[pi],
+                   "poradie", r.ns_tick, r.ns_move, r.games, r.checksum);
+        }
+        for (int ti = 0; ti < (int)(sizeof(threads) / sizeof(threads[0])); ti++) {
+            if (ti > 0 && threads[ti] == 0) continue;
+            pool_t *pool = threads[ti] ? pool_create(threads[ti]) : NULL;
+            if (threads[ti] && !pool) continue;
+            if (run(MAX_MAP_SIZE, big_players[pi], INITIAL_SNAKE_LEN, TICK_TWO_PHASE, pool, big_ticks, &r) == 0) {
+                printf("%3dx%-3d %6d %8d %12.1f %12.1f %8ld %12lu\n", MAX_MAP_SIZE, MAX_MAP_SIZE, big_players[pi],
+                       threads[ti], r.ns_tick, r.ns_move, r.games, r.checksum);
+            }
+            pool_free(pool);
+        }
+    }
+    return 0;
+}
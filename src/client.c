@@ -1,4 +1,7 @@
 #include "snake.h"
+#include "proto.h"
+#include "render.h"
+#include "predict.h"
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <termios.h>
@@ -8,7 +11,6 @@
 #include <stdarg.h>
 #include <signal.h>
 
-#define FRAME_BUF_SIZE 65536
 
 typedef struct {
     struct termios orig;
@@ -16,19 +18,44 @@ typedef struct {
     int active;
 } TermGuard;
 
+// prijaté bajty zo servera; head/tail sú počítadlá, index do buf je & (size - 1);
+// buffer rastie (mocniny 2), keď sa doň nezmestí jeden rámec (kľúčový stav veľkej mapy)
+#define RX_RING_MIN (1 << 17)
+#define RX_RING_MAX (2 * PROTO_MAX_FRAME)
+
+typedef struct {
+    char *buf;
+    char *scratch;          // rámec, ktorý sa láme cez koniec buf
+    unsigned long size;
+    unsigned long head;     // prvý nespracovaný bajt
+    unsigned long tail;     // za posledným prijatým
+} rx_ring_t;
+
 typedef struct {
     int sock;
     int port;
     GameState game_state;
     int player_id;
     int in_game;
-    char world[MAX_MAP_SIZE][MAX_MAP_SIZE];
     int server_pid;
+    int binary;     // server prijal HELLO, hovorí sa binárnym protokolom
+    uint32_t state_seq;     // posledný stav, na ktorý môže nadviazať delta
+    int have_keyframe;
+    ViewRect view;          // výrez z posledného stavu, w == 0 = celá mapa
+    int view_req_w;         // naposledy vyžiadaný výrez (MSG_VIEW)
+    int view_req_h;
+
+    rx_ring_t rx;
+    unsigned long frames_dropped;   // staré stavy preskočené pri dobiehaní
+
+    predict_t pred;
+    int predict;    // kresliť vlastného hadíka dopredu (kláves P)
 } client_ctx_t;
 
-static void clear_screen(void) {
-    // HOME + clear from cursor to end of screen (fix ghosting / flicker)
-    printf("\033[H\033[J");
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
 }
 
 static int read_port_loop(const char *prompt) {
@@ -48,6 +75,77 @@ static int read_port_loop(const char *prompt) {
     }
 }
 
+// prečíta jeden riadok odpovede servera (mimo herného cyklu), 0 = nič neprišlo
+static int recv_line(client_ctx_t *C, char *out, int cap, int timeout_ms) {
+    int len = 0;
+    while (len < cap - 1) {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(C->sock, &rfds);
+        struct timeval tv;
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        if (select(C->sock + 1, &rfds, NULL, NULL, &tv) <= 0) break;
+
+        char ch;
+        if (recv(C->sock, &ch, 1, 0) != 1) break;
+        if (ch == '\n') break;
+        out[len++] = ch;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static int wait_readable(int fd, int timeout_ms) {
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    return select(fd + 1, &rfds, NULL, NULL, &tv) > 0;
+}
+
+static int recv_exact(client_ctx_t *C, uint8_t *out, int n, int timeout_ms) {
+    int got = 0;
+    while (got < n) {
+        if (!wait_readable(C->sock, timeout_ms)) return -1;
+        ssize_t r = recv(C->sock, out + got, (size_t)(n - got), 0);
+        if (r <= 0) return -1;
+        got += (int)r;
+    }
+    return 0;
+}
+
+// prečíta jeden binárny rámec (mimo herného cyklu), vráti dĺžku payloadu alebo -1
+static int recv_frame(client_ctx_t *C, uint8_t *out, int cap, MessageType *type, int timeout_ms) {
+    if (recv_exact(C, out, PROTO_HEADER_SIZE, timeout_ms) < 0) return -1;
+
+    uint32_t n = ((uint32_t)out[0] << 24) | ((uint32_t)out[1] << 16) | ((uint32_t)out[2] << 8) | out[3];
+    int plen = (int)n - 1;
+    if (n < 1 || plen > cap) return -1;
+    *type = (MessageType)out[4];
+
+    if (recv_exact(C, out, plen, timeout_ms) < 0) return -1;
+    return plen;
+}
+
+// HELLO pri pripojení; starý server neodpovie a zostane sa pri texte
+static void negotiate_protocol(client_ctx_t *C) {
+    char msg[32];
+    snprintf(msg, sizeof(msg), "HELLO|%d\n", PROTO_VERSION);
+    send(C->sock, msg, strlen(msg), 0);
+
+    char line[64];
+    int ver = 0;
+    C->binary = 0;
+    if (recv_line(C, line, (int)sizeof(line), 500) > 0 &&
+        sscanf(line, "HELLO|%d|", &ver) == 1 && ver >= 1) {
+        C->binary = 1;
+    }
+    printf("[KLIENT] Protokol: %s\n", C->binary ? "binárny" : "textový");
+}
+
 static int connect_to_server(client_ctx_t *C, int port) {
     C->sock = socket(AF_INET, SOCK_STREAM, 0);
     if (C->sock < 0) {
@@ -60,6 +158,12 @@ static int connect_to_server(client_ctx_t *C, int port) {
     addr.sin_family = AF_INET;
     addr.sin_port = htons((uint16_t)port);
     C->port = port;
+    C->rx.head = C->rx.tail = 0;
+    C->frames_dropped = 0;
+    C->have_keyframe = 0;
+    C->view.w = 0;
+    C->view_req_w = C->view_req_h = 0;
+    predict_reset(&C->pred);
     inet_aton("127.0.0.1", &addr.sin_addr);
 
     if (connect(C->sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
@@ -70,113 +174,119 @@ static int connect_to_server(client_ctx_t *C, int port) {
     }
 
     printf("[KLIENT] Pripojené k serveru!\n");
+    negotiate_protocol(C);
     return 1;
 }
 
-static void send_message(client_ctx_t *C, const char* msg) {
+static void send_message(client_ctx_t *C, const Message *m) {
     if (!C || C->sock < 0) return;
-    send(C->sock, msg, strlen(msg), 0);
-}
 
-static void clear_world(client_ctx_t *C) {
-    for (int y = 0; y < MAX_MAP_SIZE; y++)
-        for (int x = 0; x < MAX_MAP_SIZE; x++)
-            C->world[y][x] = ' ';
+    char buf[512];
+    int len;
+    if (C->binary) {
+        wbuf_t w;
+        wbuf_init(&w, buf, (int)sizeof(buf));
+        len = (proto_encode_cmd(m, &w) == 0) ? w.len : -1;
+    } else {
+        len = proto_format_cmd_text(m, buf, (int)sizeof(buf));
+    }
+    if (len > 0) send(C->sock, buf, (size_t)len, 0);
 }
 
-static int appendf(char *dst, int cap, int off, const char *fmt, ...) {
-    if (off >= cap) return cap;
-    va_list ap;
-    va_start(ap, fmt);
-    int n = vsnprintf(dst + off, cap - off, fmt, ap);
-    va_end(ap);
-    if (n < 0) return off;
-    if (off + n >= cap) return cap;
-    return off + n;
-}
+// ---------- KRESLENIE (render.h) ----------
 
-static int line_end(int off, char *dst, int cap) {
-    return appendf(dst, cap, off, "\033[K\n");
-}
+#define PANEL_PLAYERS 4     // koľko hráčov sa vypíše nad mapou
 
-static int render_players_info_to_buf(client_ctx_t *C, char *out, int cap, int off) {
-    off = appendf(out, cap, off, "Max hráčov: %d", MAX_CLIENTS);
-    off = line_end(off, out, cap);
+// každá funkcia kreslí od riadku row a vráti prvý voľný riadok pod sebou
+static int draw_players_info(client_ctx_t *C, screen_t *s, int row) {
+    screen_printf(s, row++, 0, "Hráčov: %d", C->game_state.num_players);
 
-    for (int i = 0; i < MAX_CLIENTS; i++) {
+    for (int i = 0; i < PANEL_PLAYERS; i++) {
         if (i < C->game_state.num_players) {
             Player *p = &C->game_state.players[i];
 
-            if (!p->alive) {
-                off = appendf(out, cap, off, "Hráč %s je mŕtvy. Skóre: %d", p->name, p->score);
-                off = line_end(off, out, cap);
+            if (!player_alive(&C->game_state, i)) {
+                screen_printf(s, row++, 0, "Hráč %s je mŕtvy. Skóre: %d", p->name, p->score);
             } else {
-                off = appendf(out, cap, off, "Meno: %s", p->name); off = line_end(off, out, cap);
-                off = appendf(out, cap, off, "ID: %d", p->id);     off = line_end(off, out, cap);
-                off = appendf(out, cap, off, "Skóre: %d", p->score);off = line_end(off, out, cap);
+                screen_printf(s, row++, 0, "Meno: %s", p->name);
+                screen_printf(s, row++, 0, "ID: %d", p->id);
+                screen_printf(s, row++, 0, "Skóre: %d", p->score);
             }
         } else {
-            off = appendf(out, cap, off, "______________________________________");
-            off = line_end(off, out, cap);
+            screen_text(s, row++, 0, "______________________________________");
         }
 
-        off = line_end(off, out, cap);
+        row++;
+    }
+    if (C->game_state.num_players > PANEL_PLAYERS) {
+        screen_printf(s, row++, 0, "... a ďalší: %d", C->game_state.num_players - PANEL_PLAYERS);
     }
 
     if (C->player_id >= 0 && C->player_id < C->game_state.num_players) {
         Player *me = &C->game_state.players[C->player_id];
-        off = appendf(out, cap, off, "== TY ==");
-        off = line_end(off, out, cap);
-        off = appendf(out, cap, off, "Meno: %s | ID: %d | Skóre: %d",
-                      me->name, me->id, me->score);
-        off = line_end(off, out, cap);
-        off = line_end(off, out, cap);
+        screen_text(s, row++, 0, "== TY ==");
+        screen_printf(s, row++, 0, "Meno: %s | ID: %d | Skóre: %d", me->name, me->id, me->score);
+        row++;
     }
 
-    return off;
+    return row;
+}
+
+#define FOOTER_ROWS 3       // riadky pod mapou
+
+// výrez veľký ako miesto pod panelom; server ho použije, len keď je mapa väčšia
+static void request_view(client_ctx_t *C, int vw, int vh) {
+    if (!C->binary || C->sock < 0) return;
+    if (vw < VIEW_MIN) vw = VIEW_MIN;
+    if (vw > VIEW_MAX) vw = VIEW_MAX;
+    if (vh < VIEW_MIN) vh = VIEW_MIN;
+    if (vh > VIEW_MAX) vh = VIEW_MAX;
+    if (vw == C->view_req_w && vh == C->view_req_h) return;
+
+    Message m;
+    memset(&m, 0, sizeof(m));
+    m.type = MSG_VIEW;
+    m.args[0] = vw;
+    m.args[1] = vh;
+    send_message(C, &m);
+    C->view_req_w = vw;
+    C->view_req_h = vh;
 }
 
-static int render_world_to_buf(client_ctx_t *C, char *out, int cap, int off) {
+static int draw_world(client_ctx_t *C, screen_t *s, int row) {
     int w = C->game_state.width;
     int h = C->game_state.height;
- 
-    // bezpečnostné clampy (nie "default" pre používateľa, len ochrana buffra)
-    if (w < 1) w = 1;
-    if (h < 1) h = 1;
-    if (w > MAX_MAP_SIZE) w = MAX_MAP_SIZE;
-    if (h > MAX_MAP_SIZE) h = MAX_MAP_SIZE;
+    if (w < 1 || h < 1 || !C->game_state.grid) return row;
  
     const int CELL_W = 2; // kľúč: 2 znaky na jednu hernú bunku
- 
-    // horný rámik
-    off = appendf(out, cap, off, "\n╔");
-    for (int i = 0; i < w * CELL_W; i++) off = appendf(out, cap, off, "═");
-    off = appendf(out, cap, off, "╗");
-    off = line_end(off, out, cap);
- 
-    // telo mapy
-    for (int y = 0; y < h; y++) {
-        off = appendf(out, cap, off, "║");
-        for (int x = 0; x < w; x++) {
-            char c = C->world[y][x];
-            if (c == '.') c = ' ';
- 
-            // každý cell vytlač CELL_W krát
-            for (int r = 0; r < CELL_W; r++) {
-                off = appendf(out, cap, off, "%c", c);
-            }
-        }
-        off = appendf(out, cap, off, "║");
-        off = line_end(off, out, cap);
+
+    // prázdny riadok a rámik nad mapou, rámik a pätička pod ňou
+    request_view(C, (s->cols - 2) / CELL_W, s->rows - row - 3 - FOOTER_ROWS);
+
+    ViewRect v = C->view;
+    if (v.w == 0 || v.x + v.w > w || v.y + v.h > h) {
+        v.x = v.y = 0;
+        v.w = w;
+        v.h = h;
     }
- 
-    // spodný rámik
-    off = appendf(out, cap, off, "╚");
-    for (int i = 0; i < w * CELL_W; i++) off = appendf(out, cap, off, "═");
-    off = appendf(out, cap, off, "╝");
-    off = line_end(off, out, cap);
- 
-    return off;
+
+    // grid je stav servera, predikcia sa kreslí do kópie; kopíruje sa len výrez,
+    // bunky ostávajú na súradniciach celej mapy
+    static char *view;
+    static int view_cap;
+    if (w * h > view_cap) {
+        char *nv = (char*)realloc(view, (size_t)(w * h));
+        if (!nv) return row;
+        view = nv;
+        view_cap = w * h;
+    }
+    for (int y = v.y; y < v.y + v.h; y++) {
+        memcpy(view + y * w + v.x, C->game_state.grid + y * w + v.x, (size_t)v.w);
+    }
+    if (C->predict) predict_apply(&C->pred, &C->game_state, C->player_id, view, &v, now_sec());
+
+    // kamera servera určuje, ktorá časť mapy je na obrazovke
+    return screen_draw_map(s, row + 1, view + v.y * w + v.x, w, v.w, v.h, CELL_W);
 }
 
 
@@ -195,6 +305,13 @@ static void parse_game_state(client_ctx_t *C, const char* buffer, int *out_got_s
         return;
     }
 
+    // rozmery a počty z hlavičky určujú, koľko pamäte stav potrebuje
+    if (parts[1] < 0 || parts[2] < 0 || parts[1] > MAX_MAP_SIZE || parts[2] > MAX_MAP_SIZE ||
+        parts[3] < 0 || parts[8] < 0) {
+        return;
+    }
+    if (proto_state_reserve(&C->game_state, parts[1] * parts[2], parts[3], parts[8]) < 0) return;
+
     C->game_state.id = parts[0];
     C->game_state.width = parts[1];
     C->game_state.height = parts[2];
@@ -213,31 +330,20 @@ static void parse_game_state(client_ctx_t *C, const char* buffer, int *out_got_s
     if (!ptr) return;
     ptr++;
 
-    clear_world(C);
+    int expected = C->game_state.width * C->game_state.height;
+    memset(C->game_state.grid, CELL_EMPTY, (size_t)expected);
 
     if (ptr && strncmp(ptr, "M|", 2) == 0) {
         ptr += 2;
         const char* end = strchr(ptr, '|');
         if (!end) return;
 
-        int len = (int)(end - ptr);
-        int expected = C->game_state.width * C->game_state.height;
-
-        if (len >= expected) {
-            for (int y = 0; y < C->game_state.height && y < WORLD_HEIGHT; y++) {
-                for (int x = 0; x < C->game_state.width && x < WORLD_WIDTH; x++) {
-                    char c = ptr[y * C->game_state.width + x];
-                    if (c == '.') c = ' ';
-                    C->world[y][x] = c;
-                }
-            }
-        }
-
+        if ((int)(end - ptr) >= expected) memcpy(C->game_state.grid, ptr, (size_t)expected);
         ptr = end + 1;
     }
 
     int obs_count = 0;
-    while (ptr && strncmp(ptr, "O|", 2) == 0 && obs_count < MAX_OBSTACLES) {
+    while (ptr && strncmp(ptr, "O|", 2) == 0 && obs_count < C->game_state.obstacles_cap) {
         int ox, oy;
         if (sscanf(ptr, "O|%d|%d|", &ox, &oy) == 2) {
             C->game_state.obstacles[obs_count][0] = ox;
@@ -252,19 +358,21 @@ static void parse_game_state(client_ctx_t *C, const char* buffer, int *out_got_s
     C->game_state.num_obstacles = obs_count;
 
     int pl_count = 0;
-    while (ptr && strncmp(ptr, "P|", 2) == 0 && pl_count < 10) {
-        Player* p = &C->game_state.players[pl_count];
+    while (ptr && strncmp(ptr, "P|", 2) == 0 && pl_count < C->game_state.players_cap) {
+        GameState *g = &C->game_state;
+        Player* p = &g->players[pl_count];
         int id, alive, score, hx, hy, blen, dir;
 
         if (sscanf(ptr, "P|%d|%49[^|]|%d|%d|%d|%d|%d|%d|",
                    &id, p->name, &alive, &score, &hx, &hy, &blen, &dir) == 8) {
             p->id = id;
-            p->alive = alive;
             p->score = score;
-            p->head_x = hx;
-            p->head_y = hy;
-            p->body_len = blen;
-            p->direction = (Direction)dir;
+            g->head_x[pl_count] = (uint16_t)hx;
+            g->head_y[pl_count] = (uint16_t)hy;
+            g->body_len[pl_count] = (uint32_t)blen;
+            g->pflags[pl_count] = 0;
+            player_set_alive(g, pl_count, alive);
+            player_set_dir(g, pl_count, (Direction)(dir & PF_DIR_MASK));
             pl_count++;
         }
 
@@ -276,60 +384,212 @@ static void parse_game_state(client_ctx_t *C, const char* buffer, int *out_got_s
     if (out_got_state) *out_got_state = 1;
 }
 
-static void receive_game_state(client_ctx_t *C, int *out_got_state) {
-    if (!C || C->sock < 0) return;
+static void handle_binary_frame(client_ctx_t *C, MessageType type, const uint8_t *payload, int len,
+                                int *out_got_state) {
+    rbuf_t r;
+    rbuf_init(&r, payload, len);
+
+    if (type == MSG_ASSIGN) {
+        int id = (int)r_u32(&r);
+        if (!r.err) C->player_id = id;
+    } else if (type == MSG_GAME_STATE) {
+        if (proto_decode_state(payload, len, &C->game_state, &C->state_seq) < 0) return;
+        C->have_keyframe = 1;
+        C->view.w = 0;
+        predict_server_state(&C->pred, &C->game_state, C->player_id, now_sec());
+        if (out_got_state) *out_got_state = 1;
+    } else if (type == MSG_STATE_DELTA) {
+        // bez nadväznosti čakáme na ďalší kľúčový stav
+        if (!C->have_keyframe) return;
+        if (proto_apply_delta(payload, len, &C->game_state, &C->state_seq, NULL, NULL) != 0) return;
+        predict_server_state(&C->pred, &C->game_state, C->player_id, now_sec());
+        if (out_got_state) *out_got_state = 1;
+    } else if (type == MSG_VIEW_STATE) {
+        // mimo výrezu grid nie je aktuálny, delta naň nesmie nadviazať
+        if (proto_decode_view(payload, len, &C->game_state, &C->state_seq, &C->view) < 0) return;
+        C->have_keyframe = 0;
+        predict_server_state(&C->pred, &C->game_state, C->player_id, now_sec());
+        if (out_got_state) *out_got_state = 1;
+    }
+}
+
+// ---------- PRÍJEM ----------
 
-    static char acc[65536];   // veľký buffer
-    static int acc_len = 0;
+// zväčší buffer na dvojnásobok, neprečítané bajty ostanú na rovnakých počítadlách; -1 = už je na maxime
+static int rx_grow(rx_ring_t *r) {
+    unsigned long size = r->size ? r->size * 2 : RX_RING_MIN;
+    if (size > RX_RING_MAX) return -1;
 
-    char tmp[BUFFER_SIZE];
-    int n;
+    char *buf = (char*)malloc(size);
+    char *scratch = (char*)malloc(size);
+    if (!buf || !scratch) {
+        free(buf);
+        free(scratch);
+        return -1;
+    }
+    for (unsigned long pos = r->head; pos < r->tail; pos++) {
+        buf[pos & (size - 1)] = r->buf[pos & (r->size - 1)];
+    }
+    free(r->buf);
+    free(r->scratch);
+    r->buf = buf;
+    r->scratch = scratch;
+    r->size = size;
+    return 0;
+}
 
-    while ((n = recv(C->sock, tmp, (int)sizeof(tmp) - 1, MSG_DONTWAIT)) > 0) {
-        tmp[n] = '\0';
+static int rx_full(const rx_ring_t *r) {
+    return r->tail - r->head == r->size;
+}
 
-        if (acc_len + n >= (int)sizeof(acc) - 1) {
-            // keď pretečie, zahodíme staré (radšej prísť o frame než sa rozbiť)
-            acc_len = 0;
+// prijme, koľko sa zmestí do kruhového buffra; 1 = niečo prišlo
+static int rx_fill(rx_ring_t *r, int sock) {
+    int got = 0;
+    if (!r->buf && rx_grow(r) < 0) return 0;
+    while (!rx_full(r)) {
+        unsigned long off = r->tail & (r->size - 1);
+        unsigned long room = r->size - (r->tail - r->head);
+        if (room > r->size - off) room = r->size - off;
+
+        ssize_t n = recv(sock, r->buf + off, (size_t)room, MSG_DONTWAIT);
+        if (n > 0) {
+            r->tail += (unsigned long)n;
+            got = 1;
+            continue;
         }
+        if (n < 0 && errno == EINTR) continue;
+        break;
+    }
+    return got;
+}
+
+static unsigned char rx_byte(const rx_ring_t *r, unsigned long pos) {
+    return (unsigned char)r->buf[pos & (r->size - 1)];
+}
 
-        memcpy(acc + acc_len, tmp, (size_t)n);
-        acc_len += n;
-        acc[acc_len] = '\0';
+// dĺžka rámca od pos (binárny aj s hlavičkou, textový aj s '\n'); 0 = ešte nie je celý (aj keď sa
+// do buffra nezmestí, ten potom rastie), -1 = rozbitý prúd
+static long rx_frame_len(const rx_ring_t *r, unsigned long pos, int binary, MessageType *type) {
+    unsigned long avail = r->tail - pos;
+    if (avail == 0) return 0;
+
+    if (binary) {
+        if (avail < PROTO_HEADER_SIZE) return 0;
+        unsigned long n = ((unsigned long)rx_byte(r, pos) << 24) | ((unsigned long)rx_byte(r, pos + 1) << 16) |
+                          ((unsigned long)rx_byte(r, pos + 2) << 8) | rx_byte(r, pos + 3);
+        if (n < 1 || n > PROTO_MAX_FRAME) return -1;
+        *type = (MessageType)rx_byte(r, pos + 4);
+        return (n + 4 <= avail) ? (long)(n + 4) : 0;
     }
 
-    // nič nové
-    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-        // socket error
-        return;
+    // '\n' sa hľadá najviac v dvoch súvislých kusoch
+    unsigned long off = pos & (r->size - 1);
+    unsigned long first = (avail < r->size - off) ? avail : r->size - off;
+    const char *nl = memchr(r->buf + off, '\n', (size_t)first);
+    if (nl) return (long)(nl - (r->buf + off)) + 1;
+    if (first < avail) {
+        nl = memchr(r->buf, '\n', (size_t)(avail - first));
+        if (nl) return (long)(first + (unsigned long)(nl - r->buf)) + 1;
     }
+    return 0;
+}
 
-    char *line_start = acc;
-    while (1) {
-        char *nl = strchr(line_start, '\n');
-        if (!nl) break;
+static int rx_starts_with(const rx_ring_t *r, unsigned long pos, const char *prefix) {
+    for (unsigned long i = 0; prefix[i]; i++) {
+        if (pos + i >= r->tail || rx_byte(r, pos + i) != (unsigned char)prefix[i]) return 0;
+    }
+    return 1;
+}
 
-        *nl = '\0';
+// súvislý pohľad na rámec; kopíruje sa len rámec, ktorý sa láme cez koniec buffra
+static char* rx_view(rx_ring_t *r, unsigned long pos, long len) {
+    unsigned long off = pos & (r->size - 1);
+    if (off + (unsigned long)len <= r->size) return r->buf + off;
 
-        if (strncmp(line_start, "ASSIGN|", 7) == 0) {
-            int id;
-            if (sscanf(line_start, "ASSIGN|%d|", &id) == 1) {
-                C->player_id = id;
-            }
-        } else if (strncmp(line_start, "STATE", 5) == 0) {
-            // DEBUG: ukáž, či vôbec prišiel M|
-            // fprintf(stderr, "STATE len=%zu hasM=%d\n", strlen(line_start),
-            //         (strstr(line_start, "M|") != NULL));
-            parse_game_state(C, line_start, out_got_state);
+    unsigned long first = r->size - off;
+    memcpy(r->scratch, r->buf + off, (size_t)first);
+    memcpy(r->scratch + first, r->buf, (size_t)((unsigned long)len - first));
+    return r->scratch;
+}
+
+static void dispatch_text_line(client_ctx_t *C, char *line, int *out_got_state) {
+    if (strncmp(line, "ASSIGN|", 7) == 0) {
+        int id;
+        if (sscanf(line, "ASSIGN|%d|", &id) == 1) {
+            C->player_id = id;
+        }
+    } else if (strncmp(line, "STATE", 5) == 0) {
+        parse_game_state(C, line, out_got_state);
+    }
+}
+
+// spracuje celé rámce v buffri; zo stavov sa kreslí len najnovší celý, ostatné správy idú všetky;
+// -1 = rozbitý binárny prúd (spojenie sa už nedá použiť)
+static int rx_process(client_ctx_t *C, int *out_got_state) {
+    rx_ring_t *r = &C->rx;
+    MessageType type = MSG_NEW_GAME;
+    long len;
+
+    // 1. prechod: hranice rámcov a posledný celý stav
+    unsigned long pos = r->head, newest = 0;
+    int have_newest = 0;
+    while ((len = rx_frame_len(r, pos, C->binary, &type)) > 0) {
+        int full = C->binary ? (type == MSG_GAME_STATE || type == MSG_VIEW_STATE)
+                             : rx_starts_with(r, pos, "STATE");
+        if (full) {
+            newest = pos;
+            have_newest = 1;
+        }
+        pos += (unsigned long)len;
+    }
+    unsigned long end = pos;
+    int broken = (len < 0);
+
+    // 2. prechod: stavy pred najnovším celým stavom sa preskočia (delty pred ním tiež)
+    for (pos = r->head; pos < end; pos += (unsigned long)len) {
+        len = rx_frame_len(r, pos, C->binary, &type);
+        int is_state = C->binary ? (type == MSG_GAME_STATE || type == MSG_STATE_DELTA || type == MSG_VIEW_STATE)
+                                 : rx_starts_with(r, pos, "STATE");
+        if (is_state && have_newest && pos < newest) {
+            C->frames_dropped++;
+            continue;
         }
 
-        line_start = nl + 1;
+        char *f = rx_view(r, pos, len);
+        if (C->binary) {
+            handle_binary_frame(C, type, (const uint8_t*)f + PROTO_HEADER_SIZE, (int)len - PROTO_HEADER_SIZE,
+                                out_got_state);
+        } else {
+            f[len - 1] = '\0';
+            dispatch_text_line(C, f, out_got_state);
+        }
     }
 
-    int remaining = (int)strlen(line_start);
-    memmove(acc, line_start, (size_t)remaining);
-    acc_len = remaining;
-    acc[acc_len] = '\0';
+    // binárne rámce majú len dĺžku bez synchronizačnej značky: po zahodení bajtov by sa ďalší
+    // rámec čítal od stredu, preto je rozbitý binárny prúd koniec spojenia. Textový prúd sa zahodí
+    // a zachytí sa na najbližšom '\n'.
+    if (broken && C->binary) return -1;
+    r->head = broken ? r->tail : end;
+    return 0;
+}
+
+// -1 = binárny prúd sa rozbil, spojenie treba zavrieť
+static int receive_game_state(client_ctx_t *C, int *out_got_state) {
+    if (!C || C->sock < 0) return 0;
+
+    // plný buffer sa spracuje a číta sa ďalej, kým v sockete niečo je
+    rx_ring_t *r = &C->rx;
+    int more;
+    do {
+        more = rx_fill(r, C->sock) && rx_full(r);
+        if (rx_process(C, out_got_state) < 0) return -1;
+        // buffer stále plný = jeden rámec je väčší ako buffer
+        if (rx_full(r) && rx_grow(r) < 0) {
+            if (C->binary) return -1;
+            r->head = r->tail;
+        }
+    } while (more);
+    return 0;
 }
 
 static void show_main_menu(void) {
@@ -402,6 +662,11 @@ static void create_new_game(client_ctx_t *C) {
  
     int w = read_int_in_range("Zadaj sirku mapy", MIN_MAP_SIZE, MAX_MAP_SIZE);
     int h = read_int_in_range("Zadaj vysku mapy", MIN_MAP_SIZE, MAX_MAP_SIZE);
+
+    printf("\nVyber pohyb hadíkov:\n");
+    printf("1. Po poradí (v zrážke hláv prežije skorší hráč)\n");
+    printf("2. Naraz (v zrážke hláv zomrú obaja)\n");
+    int tick_mode = (read_int_in_range("Vybrať", 1, 2) == 2) ? TICK_TWO_PHASE : TICK_SEQUENTIAL;
  
     printf("\nSpúšťam server v pozadí...\n");
 
@@ -428,15 +693,23 @@ static void create_new_game(client_ctx_t *C) {
  
         C->player_id = -1;
  
-        char msg[256];
-
-        snprintf(msg, sizeof(msg), "NEW_GAME|%d|%d|%d|%d|%d", mode, world_type, time_limit, w, h);
-        send_message(C, msg);
+        Message m;
+        memset(&m, 0, sizeof(m));
+        m.type = MSG_NEW_GAME;
+        m.args[0] = mode;
+        m.args[1] = world_type;
+        m.args[2] = time_limit;
+        m.args[3] = w;
+        m.args[4] = h;
+        m.args[6] = tick_mode;
+        send_message(C, &m);
  
         usleep(100000);
  
-        snprintf(msg, sizeof(msg), "PLAYER|%s", name);
-        send_message(C, msg);
+        memset(&m, 0, sizeof(m));
+        m.type = MSG_PLAYER_NAME;
+        snprintf(m.data, sizeof(m.data), "%s", name);
+        send_message(C, &m);
  
         C->in_game = 1;
         printf("Hra sa spustila!\n");
@@ -449,6 +722,65 @@ static void create_new_game(client_ctx_t *C) {
     }
 }
 
+#define MAX_SHOWN_ROOMS 256
+
+// načíta zoznam miestností v texte alebo binárne, vráti počet alebo -1
+static int fetch_rooms(client_ctx_t *C, RoomInfo *rooms, int cap, int *total) {
+    Message m;
+    memset(&m, 0, sizeof(m));
+    m.type = MSG_ROOM_LIST;
+    send_message(C, &m);
+
+    int count = 0;
+    *total = 0;
+
+    if (C->binary) {
+        static uint8_t frame[PROTO_MAX_FRAME];
+        MessageType type;
+        int plen = recv_frame(C, frame, (int)sizeof(frame), &type, 1000);
+        if (plen < 0 || type != MSG_ROOMS) return -1;
+        if (proto_decode_rooms(frame, plen, rooms, cap, &count, total) < 0) return -1;
+        return count;
+    }
+
+    // celý zoznam: MAX_SHOWN_ROOMS záznamov po 7 číslach
+    static char line[32 + MAX_SHOWN_ROOMS * 86];
+    if (recv_line(C, line, (int)sizeof(line), 1000) <= 0 || strncmp(line, "ROOMS|", 6) != 0) {
+        return -1;
+    }
+
+    sscanf(line, "ROOMS|%d|", total);
+    const char *ptr = strstr(line, "R|");
+    while (ptr && count < cap) {
+        RoomInfo *ri = &rooms[count];
+        if (sscanf(ptr, "R|%d|%d|%d|%d|%d|%d|%d|", &ri->id, &ri->players, &ri->width, &ri->height,
+                   &ri->mode, &ri->world_type, &ri->max_players) == 7) {
+            count++;
+        }
+        ptr = strstr(ptr + 2, "R|");
+    }
+    return count;
+}
+
+// ukáže bežiace miestnosti a vráti vybrané id (0 = najstaršia)
+static int choose_room(client_ctx_t *C) {
+    RoomInfo rooms[MAX_SHOWN_ROOMS];
+    int total;
+    int count = fetch_rooms(C, rooms, MAX_SHOWN_ROOMS, &total);
+    if (count < 0) return 0;
+
+    printf("\nBežiace miestnosti: %d\n", total);
+    for (int i = 0; i < count; i++) {
+        RoomInfo *ri = &rooms[i];
+        printf("  #%d  hráči: %d/%d  mapa: %dx%d  %s, %s\n", ri->id, ri->players, ri->max_players,
+               ri->width, ri->height,
+               ri->mode == MODE_TIMED ? "časový" : "štandardný",
+               ri->world_type == WORLD_WITH_OBSTACLES ? "s prekážkami" : "bez prekážok");
+    }
+
+    return read_int_in_range("Zadaj číslo miestnosti (0 = prvá)", 0, 1000000000);
+}
+
 static void join_existing_game(client_ctx_t *C) {
     printf("\n╔════════════════════════════════════════╗\n");
     printf("║      PRIPOJIT SA K HRE                 ║\n");
@@ -465,9 +797,20 @@ static void join_existing_game(client_ctx_t *C) {
  
         C->player_id = -1;
  
-        char msg[256];
-        snprintf(msg, sizeof(msg), "PLAYER|%s", name);
-        send_message(C, msg);
+        Message m;
+        int room = choose_room(C);
+        if (room > 0) {
+            memset(&m, 0, sizeof(m));
+            m.type = MSG_JOIN_GAME;
+            m.game_id = room;
+            send_message(C, &m);
+            usleep(100000);
+        }
+
+        memset(&m, 0, sizeof(m));
+        m.type = MSG_PLAYER_NAME;
+        snprintf(m.data, sizeof(m.data), "%s", name);
+        send_message(C, &m);
  
         C->in_game = 1;
         printf("Poslal som PLAYER, čakám na hru...\n");
@@ -508,17 +851,42 @@ static void term_restore(TermGuard *tg) {
     tg->active = 0;
 }
 
+#define KEY_BATCH 64    // kláves prečítaných naraz
+
+static Direction opposite_dir(Direction d) {
+    switch (d) {
+        case UP:    return DOWN;
+        case DOWN:  return UP;
+        case LEFT:  return RIGHT;
+        case RIGHT: return LEFT;
+        default:    return NONE;
+    }
+}
+
+// smer, voči ktorému sa posudzuje ďalšia klávesa: posledný odoslaný, kým ho server nepotvrdí
+// alebo kým sa nepovažuje za stratený, potom smer hadíka v stave servera
+static Direction intended_dir(const client_ctx_t *C) {
+    const GameState *g = &C->game_state;
+    Direction dir;
+    if (predict_pending_dir(&C->pred, now_sec(), &dir)) return dir;
+    if (C->player_id < 0 || C->player_id >= g->num_players || !player_alive(g, C->player_id)) return NONE;
+    return player_dir(g, C->player_id);
+}
+
 static void game_loop(client_ctx_t *C) {
     TermGuard tg;
     int raw_ok = (term_enable_raw(&tg) == 0);
 
-    // clear whole screen + hide cursor once
-    printf("\033[2J\033[H\033[?25l");
+    // hide cursor once, prvý snímok prekreslí celú obrazovku
+    printf("\033[?25l");
     fflush(stdout);
 
-    Direction current_dir = RIGHT;
+    screen_t scr;
+    memset(&scr, 0, sizeof(scr));
+
     int game_active = 1;
     int paused = 0;
+    int stream_broken = 0;
 
     while (C->in_game && game_active) {
         int got_state = 0;
@@ -535,89 +903,111 @@ static void game_loop(client_ctx_t *C) {
             if (C->sock > maxfd) maxfd = C->sock;
         }
 
+        // s predikciou sa prekresľuje aj v čase lokálne predikovaného ticku
+        long wait_us = 1000000 / FPS;
+        double pw = C->predict ? predict_wait(&C->pred, now_sec()) : -1;
+        if (pw >= 0 && pw * 1e6 < wait_us) {
+            wait_us = (long)(pw * 1e6) + 1000;
+        }
+
         struct timeval tv;
         tv.tv_sec = 0;
-        tv.tv_usec = 1000000 / FPS;
+        tv.tv_usec = wait_us;
 
         int rv = select(maxfd + 1, &rfds, NULL, NULL, &tv);
 
         // ---------- RECEIVE STATE ----------
+        int rx_rc;
         if (rv > 0 && C->sock >= 0 && FD_ISSET(C->sock, &rfds)) {
-            receive_game_state(C, &got_state);
+            rx_rc = receive_game_state(C, &got_state);
         } else {
             // aj keď select neukázal socket, občas môže zostať niečo v buffri
             // (MSG_DONTWAIT vo vnútri to nezablokuje)
-            receive_game_state(C, &got_state);
+            rx_rc = receive_game_state(C, &got_state);
+        }
+        if (rx_rc < 0) {
+            stream_broken = 1;
+            break;
         }
 
         // ---------- INPUT ----------
-        char input = 0;
+        // všetky čakajúce klávesy naraz, aby rýchla kombinácia (hore a hneď doľava) neprepadla
+        char keys[KEY_BATCH];
+        ssize_t nkeys = 0;
         if (rv > 0 && FD_ISSET(STDIN_FILENO, &rfds)) {
-            ssize_t n = read(STDIN_FILENO, &input, 1);
-            if (n != 1) input = 0;
+            nkeys = read(STDIN_FILENO, keys, sizeof(keys));
+            if (nkeys < 0) nkeys = 0;
         }
 
-        switch (input) {
-            case 'W': case 'w': if (current_dir != DOWN)  current_dir = UP;    break;
-            case 'S': case 's': if (current_dir != UP)    current_dir = DOWN;  break;
-            case 'A': case 'a': if (current_dir != RIGHT) current_dir = LEFT;  break;
-            case 'D': case 'd': if (current_dir != LEFT)  current_dir = RIGHT; break;
-            case ' ': paused = !paused; break;
-            case 'Q': case 'q': {
-                C->in_game = 0;
-                game_active = 0;
-                char qmsg[64];
-                snprintf(qmsg, sizeof(qmsg), "QUIT|%d", C->player_id);
-                send_message(C, qmsg);
-                break;
+        for (ssize_t k = 0; k < nkeys && game_active; k++) {
+            Direction turn = NONE;
+            switch (keys[k]) {
+                case 'W': case 'w': turn = UP;    break;
+                case 'S': case 's': turn = DOWN;  break;
+                case 'A': case 'a': turn = LEFT;  break;
+                case 'D': case 'd': turn = RIGHT; break;
+                case ' ': paused = !paused; break;
+                case '\f': screen_invalidate(&scr); break;     // Ctrl+L
+                case 'C': case 'c': screen_set_colors(&scr, !scr.colors); break;
+                case 'P': case 'p': C->predict = !C->predict; break;
+                case 'Q': case 'q': {
+                    C->in_game = 0;
+                    game_active = 0;
+                    Message qm;
+                    memset(&qm, 0, sizeof(qm));
+                    qm.type = MSG_QUIT;
+                    qm.player_id = C->player_id;
+                    send_message(C, &qm);
+                    break;
+                }
+                default:
+                    break;
             }
-            default:
-                break;
-        }
 
-        // ---------- SEND MOVE ----------
-        if (C->in_game && game_active && !paused && C->player_id >= 0) {
-            char msg[64];
-            snprintf(msg, sizeof(msg), "MOVE|%d|%d", C->player_id, (int)current_dir);
-            send_message(C, msg);
+            // ---------- SEND MOVE ----------
+            // posiela sa len skutočná zmena smeru (intended_dir); server spraví najviac jednu za tick
+            // a jej input_seq potvrdí v stave, zahodený MOVE tak klávesu nezablokuje
+            if (turn == NONE || paused || C->player_id < 0) continue;
+            Direction cur = intended_dir(C);
+            if (turn == cur || turn == opposite_dir(cur)) continue;
+
+            Message mm;
+            memset(&mm, 0, sizeof(mm));
+            mm.type = MSG_MOVE;
+            mm.player_id = C->player_id;
+            mm.direction = turn;
+            mm.input_seq = predict_input(&C->pred, turn, now_sec());
+            send_message(C, &mm);
         }
 
         // ---------- BUILD FRAME ----------
-        static char frame[FRAME_BUF_SIZE];
-        int off = 0;
+        if (screen_fit_terminal(&scr, STDOUT_FILENO) < 0) break;
+        screen_begin(&scr);
+        int row = 0;
 
         // keď ešte nemáme STATE, aspoň niečo zobraz
         if (!got_state && C->game_state.width == 0 && C->game_state.height == 0) {
-            off = appendf(frame, (int)sizeof(frame), off, "Čakám na server... (STATE)");
-            off = line_end(off, frame, (int)sizeof(frame));
-            off = appendf(frame, (int)sizeof(frame), off, "player_id: %d", C->player_id);
-            off = line_end(off, frame, (int)sizeof(frame));
-            off = appendf(frame, (int)sizeof(frame), off, "Q=quit, SPACE=pause");
-            off = line_end(off, frame, (int)sizeof(frame));
+            screen_text(&scr, row++, 0, "Čakám na server... (STATE)");
+            screen_printf(&scr, row++, 0, "player_id: %d", C->player_id);
+            screen_text(&scr, row++, 0, "Q=quit, SPACE=pause");
         } else {
-            off = render_players_info_to_buf(C, frame, (int)sizeof(frame), off);
-            off = render_world_to_buf(C, frame, (int)sizeof(frame), off);
+            row = draw_players_info(C, &scr, row);
+            row = draw_world(C, &scr, row);
 
             if (C->player_id >= 0 && C->player_id < C->game_state.num_players) {
-                off = appendf(frame, (int)sizeof(frame), off, "Tvoj hadík: %s",
-                              C->game_state.players[C->player_id].name);
-                off = line_end(off, frame, (int)sizeof(frame));
-                off = appendf(frame, (int)sizeof(frame), off, "Tvoje body: %d | Čas: %d s",
+                screen_printf(&scr, row++, 0, "Tvoj hadík: %s", C->game_state.players[C->player_id].name);
+                screen_printf(&scr, row++, 0, "Tvoje body: %d | Čas: %d s | Preskočené stavy: %lu",
                               C->game_state.players[C->player_id].score,
-                              C->game_state.elapsed_time);
-                off = line_end(off, frame, (int)sizeof(frame));
+                              C->game_state.elapsed_time, C->frames_dropped);
             }
 
-            off = appendf(frame, (int)sizeof(frame), off,
-                          "Smer (W/S/A/D, SPACE=pause, Q=quit): %s",
-                          paused ? "[PAUSED]" : "");
-            off = line_end(off, frame, (int)sizeof(frame));
+            screen_printf(&scr, row++, 0, "Smer (W/S/A/D, SPACE=pause, C=farby, P=predikcia %s, Q=quit): %s",
+                          C->predict ? "zap" : "vyp", paused ? "[PAUSED]" : "");
         }
 
-        // ---------- DRAW FRAME (VŽDY) ----------
-        clear_screen();
-        fwrite(frame, 1, (size_t)off, stdout);
-        fflush(stdout);
+        // ---------- DRAW FRAME ----------
+        // na terminál ide len to, čo sa od minulého snímku zmenilo
+        screen_flush(&scr, STDOUT_FILENO);
 
         if (C->game_state.game_over) {
             C->in_game = 0;
@@ -625,10 +1015,19 @@ static void game_loop(client_ctx_t *C) {
         }
     }
 
-    printf("\033[?25h");
+    // kurzor pod posledný snímok
+    printf("\033[%d;1H\033[?25h\n", scr.rows);
     fflush(stdout);
+    screen_free(&scr);
 
     if (raw_ok) term_restore(&tg);
+
+    if (stream_broken) {
+        close(C->sock);
+        C->sock = -1;
+        C->in_game = 0;
+        printf("Chyba: Server poslal poškodený rámec, spojenie sa zavrelo. Pripoj sa znova z menu.\n");
+    }
 }
 
 int main(void) {
@@ -639,7 +1038,7 @@ int main(void) {
     C.player_id = -1;
     C.in_game = 0;
     C.server_pid = -1;
-    clear_world(&C);
+    C.predict = 1;
 
     printf("╔══════════════════════════════╗\n");
     printf("║     VITAJ V HRE HADIK!       ║\n");
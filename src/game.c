@@ -0,0 +1,783 @@
+#include "game.h"
+
+int game_log = 1;
+
+#define GAME_LOG(...) do { if (game_log) fprintf(stderr, __VA_ARGS__); } while (0)
+
+#define BODY_MIN_CAP 16
+// hadíci, ktorí sa nezmestia do stredného riadku, sa rozhodia po mape postupnosťou R2 (Roberts):
+// i-ty bod je (i/ρ, i/ρ²) mod 1, ρ ≈ 1,3247 je plastické číslo, kroky sú v pevnej čiarke 1/65536.
+// Pre ľubovoľný počet hadíkov pokrýva mapu rovnomerne, bez riadkov a zhlukov, ktoré dáva jeden
+// celočíselný krok (i * k % šírka), a je deterministická (replay).
+#define SPAWN_STEP_X 49471      // 65536 / ρ
+#define SPAWN_STEP_Y 37345      // 65536 / ρ²
+
+// index i-teho článku (0 = hlava) v kruhovom buffri tela
+static int body_index(const SnakeBody *b, int i) {
+    int k = b->head - i;
+    return k < 0 ? k + b->cap : k;
+}
+
+// ---------- PAMÄŤ ----------
+
+// pole z old na n prvkov, nové prvky sú vynulované
+static int resize_array(void **arr, int old, int n, size_t elem) {
+    char *p = (char*)realloc(*arr, (size_t)n * elem);
+    if (!p) return -1;
+    if (n > old) memset(p + (size_t)old * elem, 0, (size_t)(n - old) * elem);
+    *arr = p;
+    return 0;
+}
+
+// zväčší pole na aspoň need prvkov (zdvojnásobovaním), nové prvky sú vynulované
+static int grow_array(void **arr, int *cap, int need, size_t elem) {
+    if (need <= *cap) return 0;
+    int ncap = *cap ? *cap * 2 : 4;
+    while (ncap < need) ncap *= 2;
+    if (resize_array(arr, *cap, ncap, elem) < 0) return -1;
+    *cap = ncap;
+    return 0;
+}
+
+// všetky polia hráčov (horúce aj studené) na aspoň need hráčov
+static int players_reserve(GameState *g, int need) {
+    if (need <= g->players_cap) return 0;
+    int old = g->players_cap;
+    int cap = old ? old * 2 : 4;
+    while (cap < need) cap *= 2;
+
+    if (resize_array((void**)&g->head_x, old, cap, sizeof(g->head_x[0])) < 0 ||
+        resize_array((void**)&g->head_y, old, cap, sizeof(g->head_y[0])) < 0 ||
+        resize_array((void**)&g->pflags, old, cap, sizeof(g->pflags[0])) < 0 ||
+        resize_array((void**)&g->body_len, old, cap, sizeof(g->body_len[0])) < 0 ||
+        resize_array((void**)&g->next_seq, old, cap, sizeof(g->next_seq[0])) < 0 ||
+        resize_array((void**)&g->input_seq, old, cap, sizeof(g->input_seq[0])) < 0 ||
+        resize_array((void**)&g->bodies, old, cap, sizeof(g->bodies[0])) < 0 ||
+        resize_array((void**)&g->players, old, cap, sizeof(g->players[0])) < 0 ||
+        resize_array((void**)&g->next_cell, old, cap, sizeof(g->next_cell[0])) < 0 ||
+        resize_array((void**)&g->intent, old, cap, sizeof(g->intent[0])) < 0) {
+        return -1;
+    }
+    g->players_cap = cap;
+    return 0;
+}
+
+// telo s kapacitou aspoň need článkov; len článkov sa preskladá od chvosta, hlava je na len - 1
+static int body_reserve(SnakeBody *b, int len, int need) {
+    if (need <= b->cap) return 0;
+    int cap = b->cap ? b->cap : BODY_MIN_CAP;
+    while (cap < need) cap *= 2;
+
+    uint16_t *bx = (uint16_t*)malloc((size_t)cap * sizeof(uint16_t));
+    uint16_t *by = (uint16_t*)malloc((size_t)cap * sizeof(uint16_t));
+    if (!bx || !by) {
+        free(bx);
+        free(by);
+        return -1;
+    }
+    for (int i = 0; i < len; i++) {
+        int k = body_index(b, len - 1 - i);
+        bx[i] = b->x[k];
+        by[i] = b->y[k];
+    }
+    free(b->x);
+    free(b->y);
+    b->x = bx;
+    b->y = by;
+    b->cap = cap;
+    b->head = (len > 0) ? len - 1 : 0;
+    return 0;
+}
+
+// mriežka a zoznamy buniek pre mapu s area bunkami; väčšia alokácia z predošlej hry sa ponechá
+static int cells_reserve(GameState *g, int area) {
+    if (area <= g->cells_cap) return 0;
+
+    char *grid = (char*)realloc(g->grid, (size_t)area);
+    if (grid) g->grid = grid;
+    int *free_cells = (int*)realloc(g->free_cells, (size_t)area * sizeof(int));
+    if (free_cells) g->free_cells = free_cells;
+    int *free_pos = (int*)realloc(g->free_pos, (size_t)area * sizeof(int));
+    if (free_pos) g->free_pos = free_pos;
+    int *dirty_cells = (int*)realloc(g->dirty_cells, (size_t)area * sizeof(int));
+    if (dirty_cells) g->dirty_cells = dirty_cells;
+    char *dirty_mark = (char*)realloc(g->dirty_mark, (size_t)area);
+    if (dirty_mark) g->dirty_mark = dirty_mark;
+    int *claim = (int*)realloc(g->claim, (size_t)area * sizeof(int));
+    if (claim) g->claim = claim;
+
+    if (!grid || !free_cells || !free_pos || !dirty_cells || !dirty_mark || !claim) return -1;
+    g->cells_cap = area;
+    return 0;
+}
+
+void game_free(GameState *g) {
+    for (int i = 0; i < g->players_cap; i++) {
+        free(g->bodies[i].x);
+        free(g->bodies[i].y);
+    }
+    free(g->head_x);
+    free(g->head_y);
+    free(g->pflags);
+    free(g->body_len);
+    free(g->next_seq);
+    free(g->input_seq);
+    free(g->bodies);
+    free(g->players);
+    free(g->next_cell);
+    free(g->intent);
+    free(g->fruits);
+    free(g->obstacles);
+    free(g->grid);
+    free(g->free_cells);
+    free(g->free_pos);
+    free(g->dirty_cells);
+    free(g->dirty_mark);
+    free(g->claim);
+    memset(g, 0, sizeof(*g));
+}
+
+size_t game_memory(const GameState *g) {
+    size_t per_player = sizeof(g->head_x[0]) + sizeof(g->head_y[0]) + sizeof(g->pflags[0]) +
+                        sizeof(g->body_len[0]) + sizeof(g->next_seq[0]) + sizeof(g->input_seq[0]) +
+                        sizeof(SnakeBody) + sizeof(Player) + sizeof(g->next_cell[0]) + sizeof(g->intent[0]);
+    size_t n = sizeof(*g) + (size_t)g->players_cap * per_player;
+    for (int i = 0; i < g->players_cap; i++) n += (size_t)g->bodies[i].cap * 2 * sizeof(uint16_t);
+    n += (size_t)(g->fruits_cap + g->obstacles_cap) * sizeof(g->fruits[0]);
+    n += (size_t)g->cells_cap * (2 + 4 * sizeof(int));
+    return n;
+}
+
+// ---------- MRIEŽKA OBSADENOSTI ----------
+
+static int in_bounds(const GameState *g, int x, int y) {
+    return x >= 0 && x < g->width && y >= 0 && y < g->height;
+}
+
+static char grid_get(const GameState *g, int x, int y) {
+    return g->grid[y * g->width + x];
+}
+
+static void free_remove(GameState *g, int cell) {
+    int pos = g->free_pos[cell];
+    int last = g->free_cells[--g->num_free];
+    g->free_cells[pos] = last;
+    g->free_pos[last] = pos;
+    g->free_pos[cell] = -1;
+}
+
+static void free_add(GameState *g, int cell) {
+    g->free_pos[cell] = g->num_free;
+    g->free_cells[g->num_free++] = cell;
+}
+
+static void grid_set(GameState *g, int x, int y, char c) {
+    int cell = y * g->width + x;
+    char old = g->grid[cell];
+    if (old == c) return;
+
+    if (old == CELL_EMPTY) free_remove(g, cell);
+    else if (c == CELL_EMPTY) free_add(g, cell);
+    g->grid[cell] = c;
+
+    if (!g->dirty_mark[cell]) {
+        g->dirty_mark[cell] = 1;
+        g->dirty_cells[g->num_dirty++] = cell;
+    }
+}
+
+void dirty_clear(GameState *g) {
+    for (int i = 0; i < g->num_dirty; i++) g->dirty_mark[g->dirty_cells[i]] = 0;
+    g->num_dirty = 0;
+}
+
+static void grid_reset(GameState *g) {
+    int n = g->width * g->height;
+    memset(g->grid, CELL_EMPTY, (size_t)n);
+    for (int i = 0; i < n; i++) {
+        g->free_cells[i] = i;
+        g->free_pos[i] = i;
+        g->claim[i] = -1;
+    }
+    g->num_free = n;
+
+    memset(g->dirty_mark, 0, (size_t)n);
+    g->num_dirty = 0;
+}
+
+static int cell_free(const GameState *g, int x, int y) {
+    return grid_get(g, x, y) == CELL_EMPTY;
+}
+
+// ---------- NÁHODA ----------
+
+// každá hra má vlastný generátor (xorshift64*), rovnaký seed a vstupy dajú rovnakú hru
+static void rng_seed(GameState *g, uint64_t seed) {
+    // splitmix64, aby aj malé seedy dali dobre rozhádzaný nenulový stav
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    g->seed = seed;
+    g->rng = z ? z : 1;
+}
+
+static uint32_t rng_next(GameState *g) {
+    uint64_t x = g->rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    g->rng = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// náhodná voľná bunka jedným ťahom, -1 ak je mapa plná
+static int random_free_cell(GameState *g, int *x, int *y) {
+    if (g->num_free <= 0) return -1;
+    int cell = g->free_cells[rng_next(g) % (uint32_t)g->num_free];
+    *x = cell % g->width;
+    *y = cell / g->width;
+    return 0;
+}
+
+static void generate_obstacles_random(GameState *g, int count) {
+    g->num_obstacles = 0;
+    if (count > g->obstacles_cap &&
+        grow_array((void**)&g->obstacles, &g->obstacles_cap, count, sizeof(g->obstacles[0])) < 0) {
+        count = g->obstacles_cap;
+    }
+
+    while (g->num_obstacles < count) {
+        int x, y;
+        if (random_free_cell(g, &x, &y) < 0) break;
+
+        g->obstacles[g->num_obstacles][0] = x;
+        g->obstacles[g->num_obstacles][1] = y;
+        g->num_obstacles++;
+        grid_set(g, x, y, CELL_OBSTACLE);
+    }
+
+    GAME_LOG("[SERVER] %d prekážok vygenerovaných\n", g->num_obstacles);
+}
+
+static int alive_snakes(const GameState *g) {
+    int c = 0;
+    for (int i = 0; i < g->num_players; i++) c += g->pflags[i] & PF_ALIVE;
+    return c;
+}
+ 
+static void sync_legacy_fruit_xy(GameState *g) {
+    if (g->num_fruits > 0) {
+        g->fruit_x = g->fruits[0][0];
+        g->fruit_y = g->fruits[0][1];
+    } else {
+        g->fruit_x = -1;
+        g->fruit_y = -1;
+    }
+}
+ 
+int spawn_fruit_at(GameState *g, int idx) {
+    int x, y;
+    if (random_free_cell(g, &x, &y) < 0) {
+        GAME_LOG("[SERVER] Ovocie[%d] sa nezmestí, mapa je plná\n", idx);
+        return -1;
+    }
+ 
+    g->fruits[idx][0] = x;
+    g->fruits[idx][1] = y;
+    grid_set(g, x, y, CELL_FRUIT);
+ 
+    sync_legacy_fruit_xy(g);
+ 
+    GAME_LOG("[SERVER] Ovocie[%d] vygenerované: (%d, %d)\n", idx, x, y);
+    return 0;
+}
+
+// odstráni ovocie idx, posledné sa presunie na jeho miesto
+static void remove_fruit(GameState *g, int idx) {
+    int fx = g->fruits[idx][0], fy = g->fruits[idx][1];
+    if (grid_get(g, fx, fy) == CELL_FRUIT) grid_set(g, fx, fy, CELL_EMPTY);
+
+    g->num_fruits--;
+    g->fruits[idx][0] = g->fruits[g->num_fruits][0];
+    g->fruits[idx][1] = g->fruits[g->num_fruits][1];
+    sync_legacy_fruit_xy(g);
+}
+ 
+void ensure_fruits_count(GameState *g) {
+    // jedno ovocie na živého hadíka, pole ovocí rastie spolu s hráčmi
+    int want = alive_snakes(g);
+    if (want > g->fruits_cap) want = g->fruits_cap;
+ 
+    while (g->num_fruits < want) {
+        if (spawn_fruit_at(g, g->num_fruits) < 0) break;
+        g->num_fruits++;
+    }
+ 
+    while (g->num_fruits > want) {
+        remove_fruit(g, g->num_fruits - 1);
+    }
+ 
+    sync_legacy_fruit_xy(g);
+}
+
+int init_game(GameState *g, int width, int height, GameMode mode, int time_limit, WorldType world_type,
+              uint64_t seed) {
+    if (width < MIN_MAP_SIZE) width = MIN_MAP_SIZE;
+    if (width > MAX_MAP_SIZE) width = MAX_MAP_SIZE;
+    if (height < MIN_MAP_SIZE) height = MIN_MAP_SIZE;
+    if (height > MAX_MAP_SIZE) height = MAX_MAP_SIZE;
+    if (cells_reserve(g, width * height) < 0) return -1;
+
+    rng_seed(g, seed);
+    g->id = (int)(rng_next(g) % 10000);
+    g->width = width;
+    g->height = height;
+    g->num_players = 0;
+    g->mode = mode;
+    g->time_limit = time_limit;
+    g->elapsed_time = 0;
+    g->active = 0;
+    g->game_over = 0;
+    g->world_type = world_type;
+    g->tick_rate = FPS;
+    g->tick = 0;
+
+    grid_reset(g);
+
+    g->num_obstacles = 0;
+    if (world_type == WORLD_WITH_OBSTACLES) {
+        int obstacle_count = (width * height) / OBSTACLE_CELLS;
+        if (obstacle_count < MIN_OBSTACLES) obstacle_count = MIN_OBSTACLES;
+        generate_obstacles_random(g, obstacle_count);
+    }
+
+    g->num_fruits = 0;
+    ensure_fruits_count(g);
+
+    GAME_LOG("[SERVER] Hra inicializovaná: %dx%d, režim: %d, svet: %d\n",
+            width, height, mode, world_type);
+    return 0;
+}
+
+// hadík rastie doľava od hlavy, všetky jeho bunky musia byť voľné
+static int spawn_fits(const GameState *g, int hx, int hy, int len) {
+    for (int i = 0; i < len; i++) {
+        int bx = hx - i;
+        if (bx < 0) bx += g->width;
+        if (!cell_free(g, bx, hy)) return 0;
+    }
+    return 1;
+}
+
+static int find_spawn(const GameState *g, int len, int *hx, int *hy) {
+    if (spawn_fits(g, *hx, *hy, len)) return 1;
+
+    // od stredu mapy striedavo nahor a nadol
+    for (int d = 0; d < g->height; d++) {
+        int y = g->height / 2 + ((d % 2) ? -(d + 1) / 2 : d / 2);
+        if (y < 0 || y >= g->height) continue;
+        for (int x = len - 1; x < g->width; x++) {
+            if (spawn_fits(g, x, y, len)) {
+                *hx = x;
+                *hy = y;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int init_snake(GameState *g, int player_id, const char *name) {
+    return spawn_snake(g, player_id, name, INITIAL_SNAKE_LEN);
+}
+
+int spawn_snake(GameState *g, int player_id, const char *name, int len) {
+    // player_id je slot: num_players pridá nový na koniec, menší znova použije slot mŕtveho hadíka
+    if (player_id < 0 || player_id > g->num_players) return -1;
+    if (player_id < g->num_players && player_alive(g, player_id)) return -1;
+    if (player_id == g->num_players && g->num_players >= MAX_PLAYERS) return -1;
+    if (len < 1) len = 1;
+    if (len > g->width) return -1;
+
+    int i = player_id;
+    if (players_reserve(g, i + 1) < 0 ||
+        grow_array((void**)&g->fruits, &g->fruits_cap, i + 1, sizeof(g->fruits[0])) < 0) {
+        return -1;
+    }
+    SnakeBody *b = &g->bodies[i];
+    if (body_reserve(b, 0, len) < 0) return -1;
+
+    int hx = 5 + i * 5;
+    int hy = g->height / 2;
+    if (hx >= g->width) {
+        // stredný riadok je plný: ďalší idú na bod R2 (SPAWN_STEP_*), inak by začínali natlačení
+        // hlavou na chvoste suseda
+        hx = (int)(((long long)i * SPAWN_STEP_X & 0xFFFF) * g->width >> 16);
+        hy = (int)(((long long)i * SPAWN_STEP_Y & 0xFFFF) * g->height >> 16);
+    }
+
+    if (!find_spawn(g, len, &hx, &hy)) {
+        GAME_LOG("[SERVER] Pre hadíka '%s' nie je na mape miesto\n", name);
+        return -1;
+    }
+
+    Player *p = &g->players[i];
+    p->id = player_id;
+    p->score = 0;
+    strncpy(p->name, name, sizeof(p->name) - 1);
+    p->name[sizeof(p->name) - 1] = '\0';
+
+    g->pflags[i] = (uint8_t)(PF_ALIVE | (RIGHT << PF_DIR_SHIFT) | (RIGHT << PF_NEXT_SHIFT));
+    g->next_seq[i] = 0;
+    g->input_seq[i] = 0;
+
+    g->head_x[i] = (uint16_t)hx;
+    g->head_y[i] = (uint16_t)hy;
+    g->body_len[i] = (uint32_t)len;
+    b->head = len - 1;
+
+    for (int k = 0; k < len; k++) {
+        int bx = hx - k;
+        if (bx < 0) bx += g->width;
+
+        int j = body_index(b, k);
+        b->x[j] = (uint16_t)bx;
+        b->y[j] = (uint16_t)hy;
+        grid_set(g, bx, hy, k == 0 ? CELL_HEAD : CELL_BODY);
+    }
+
+    if (i == g->num_players && ++g->num_players == 1) {
+        g->active = 1;
+        g->game_over = 0;
+        g->tick = 0;
+    }
+
+    GAME_LOG("[SERVER] Hadík '%s' vytvorený (ID: %d)\n", p->name, player_id);
+    ensure_fruits_count(g);
+    return player_id;
+}
+
+// mŕtvy hadík zmizne z mapy
+void kill_snake(GameState *g, int i) {
+    if (!player_alive(g, i)) return;
+    player_set_alive(g, i, 0);
+
+    const SnakeBody *b = &g->bodies[i];
+    int len = (int)g->body_len[i];
+    for (int k = 0; k < len; k++) {
+        int j = body_index(b, k);
+        int x = b->x[j], y = b->y[j];
+        if (!in_bounds(g, x, y)) continue;
+        char c = grid_get(g, x, y);
+        if (c == CELL_BODY || c == CELL_HEAD) grid_set(g, x, y, CELL_EMPTY);
+    }
+}
+
+// kam sa pohne hlava v smere dir; 0 = mimo mapy (vo svete s prekážkami náraz do okraja)
+static int step_head(const GameState *g, Direction dir, int head_x, int head_y, int *nx, int *ny) {
+    int new_x = head_x;
+    int new_y = head_y;
+
+    switch (dir) {
+        case UP:    new_y--; break;
+        case DOWN:  new_y++; break;
+        case LEFT:  new_x--; break;
+        case RIGHT: new_x++; break;
+        case NONE:  break;
+    }
+
+    if (g->world_type == WORLD_NO_OBSTACLES) {
+        if (new_x < 0) new_x = g->width - 1;
+        if (new_x >= g->width) new_x = 0;
+        if (new_y < 0) new_y = g->height - 1;
+        if (new_y >= g->height) new_y = 0;
+    } else if (!in_bounds(g, new_x, new_y)) {
+        return 0;
+    }
+    *nx = new_x;
+    *ny = new_y;
+    return 1;
+}
+
+// (x, y) je článok hadíka i
+static int own_body(const GameState *g, int i, int x, int y) {
+    const SnakeBody *b = &g->bodies[i];
+    int len = (int)g->body_len[i];
+    for (int k = 0; k < len; k++) {
+        int j = body_index(b, k);
+        if (b->x[j] == x && b->y[j] == y) return 1;
+    }
+    return 0;
+}
+
+// posunie hadíka i na (new_x, new_y), ktorá je voľná, s ovocím alebo jeho chvostom
+static void move_head(GameState *g, int i, int new_x, int new_y, int grow) {
+    SnakeBody *b = &g->bodies[i];
+    int len = (int)g->body_len[i];
+    int tail = body_index(b, len - 1);
+
+    if (!grow) {
+        grid_set(g, b->x[tail], b->y[tail], CELL_EMPTY);
+    }
+    if (len > 1 || grow) {
+        grid_set(g, g->head_x[i], g->head_y[i], CELL_BODY);
+    }
+
+    // nová hlava sa zapíše za starú, chvost sa posunie sám (pri raste zostane)
+    b->head = (b->head + 1) % b->cap;
+    if (grow) g->body_len[i] = (uint32_t)(len + 1);
+
+    g->head_x[i] = (uint16_t)new_x;
+    g->head_y[i] = (uint16_t)new_y;
+    b->x[b->head] = (uint16_t)new_x;
+    b->y[b->head] = (uint16_t)new_y;
+    grid_set(g, new_x, new_y, CELL_HEAD);
+}
+
+// hadík i zjedol ovocie f; -1 = nové sa nezmestilo a na f je teraz posledné ovocie
+static int eat_fruit(GameState *g, int i, int f) {
+    Player *p = &g->players[i];
+    p->score += 10;
+    GAME_LOG("[SERVER] Hadík '%s' zjedol ovocie[%d]! Body: %d\n", p->name, f, p->score);
+    if (spawn_fruit_at(g, f) < 0) {
+        remove_fruit(g, f);
+        return -1;
+    }
+    return 0;
+}
+
+void update_snake(GameState *g, int i) {
+    uint8_t flags = g->pflags[i];
+    if (!(flags & PF_ALIVE)) return;
+
+    // ďalší smer sa stáva aktuálnym
+    Direction dir = (Direction)((flags >> PF_NEXT_SHIFT) & PF_DIR_MASK);
+    g->pflags[i] = (uint8_t)((flags & ~(PF_DIR_MASK << PF_DIR_SHIFT)) | ((unsigned)dir << PF_DIR_SHIFT));
+    g->input_seq[i] = g->next_seq[i];
+
+    int new_x, new_y;
+    if (!step_head(g, dir, g->head_x[i], g->head_y[i], &new_x, &new_y)) {
+        kill_snake(g, i);
+        GAME_LOG("[SERVER] Hadík '%s' narazil do okraja!\n", g->players[i].name);
+        return;
+    }
+
+    SnakeBody *b = &g->bodies[i];
+    int len = (int)g->body_len[i];
+    int tail = body_index(b, len - 1);
+    char target = grid_get(g, new_x, new_y);
+
+    if (target == CELL_OBSTACLE) {
+        kill_snake(g, i);
+        GAME_LOG("[SERVER] Hadík '%s' narazil do prekážky!\n", g->players[i].name);
+        return;
+    }
+
+    if (target == CELL_BODY || target == CELL_HEAD) {
+        // vlastný chvost sa v tomto ťahu uvoľní
+        int own_tail = (new_x == b->x[tail] && new_y == b->y[tail]);
+        if (!own_tail) {
+            int own = own_body(g, i, new_x, new_y);
+            kill_snake(g, i);
+            if (own) GAME_LOG("[SERVER] Hadík '%s' narazil sám do seba!\n", g->players[i].name);
+            else     GAME_LOG("[SERVER] Hadík '%s' narazil do iného hadíka!\n", g->players[i].name);
+            return;
+        }
+    }
+
+    // bez pamäte na dlhšie telo hadík len nevyrastie
+    int grow = (target == CELL_FRUIT && body_reserve(b, len, len + 1) == 0);
+    move_head(g, i, new_x, new_y, grow);
+
+    if (target != CELL_FRUIT) return;
+
+    for (int f = 0; f < g->num_fruits; f++) {
+        if (new_x == g->fruits[f][0] && new_y == g->fruits[f][1]) {
+            eat_fruit(g, i, f);
+            break;
+        }
+    }    
+}
+
+// ---------- DVOJFÁZOVÝ TICK ----------
+//
+// Fáza 1 (paralelne, mriežku len číta): každý živý hadík zistí, kam sa pohne hlava a čo tam
+// je na začiatku ticku. Fáza 2 (jedno vlákno): hadíky, ktoré si nárokujú tú istú bunku, zomrú
+// všetky (zrážka hláv, aj o ovocie), potom v poradí indexov zomrú tí, čo narazili, ostatní
+// sa pohnú a nakoniec sa doplní zjedené ovocie. Všetko vo fáze 2 ide v poradí indexov a generátor
+// hry volá len ona, preto je výsledok rovnaký pri akomkoľvek počte vlákien. Obsadená bunka je
+// prekážkou aj keď sa z nej cudzí chvost v tom istom ticku odsúva; uvoľní sa len vlastný chvost.
+
+// hadíkov na jeden úsek fázy 1, menej sa nevyplatí rozdávať vláknam
+#define INTENT_CHUNK 256
+
+enum {
+    INTENT_NONE,        // mŕtvy na začiatku ticku
+    INTENT_MOVE,
+    INTENT_EAT,
+    INTENT_WALL,        // ďalej sú zámery, ktoré končia smrťou
+    INTENT_OBSTACLE,
+    INTENT_SELF,
+    INTENT_OTHER,
+    INTENT_HEAD_ON
+};
+
+static void intent_range(void *ctx, int from, int to) {
+    GameState *g = (GameState*)ctx;
+
+    for (int i = from; i < to; i++) {
+        uint8_t flags = g->pflags[i];
+        g->next_cell[i] = -1;
+        if (!(flags & PF_ALIVE)) {
+            g->intent[i] = INTENT_NONE;
+            continue;
+        }
+
+        Direction dir = (Direction)((flags >> PF_NEXT_SHIFT) & PF_DIR_MASK);
+        g->pflags[i] = (uint8_t)((flags & ~(PF_DIR_MASK << PF_DIR_SHIFT)) | ((unsigned)dir << PF_DIR_SHIFT));
+        g->input_seq[i] = g->next_seq[i];
+
+        int new_x, new_y;
+        if (!step_head(g, dir, g->head_x[i], g->head_y[i], &new_x, &new_y)) {
+            g->intent[i] = INTENT_WALL;
+            continue;
+        }
+
+        SnakeBody *b = &g->bodies[i];
+        int len = (int)g->body_len[i];
+        int tail = body_index(b, len - 1);
+        char target = grid_get(g, new_x, new_y);
+        uint8_t intent = INTENT_MOVE;
+
+        if (target == CELL_OBSTACLE) {
+            intent = INTENT_OBSTACLE;
+        } else if (target == CELL_BODY || target == CELL_HEAD) {
+            if (new_x != b->x[tail] || new_y != b->y[tail]) {
+                intent = own_body(g, i, new_x, new_y) ? INTENT_SELF : INTENT_OTHER;
+            }
+        } else if (target == CELL_FRUIT) {
+            // telo sa zväčší už tu, každé vlákno alokuje len pre svojich hadíkov
+            body_reserve(b, len, len + 1);
+            intent = INTENT_EAT;
+        }
+        g->intent[i] = intent;
+        if (intent == INTENT_MOVE || intent == INTENT_EAT) g->next_cell[i] = new_y * g->width + new_x;
+    }
+}
+
+static void resolve_tick(GameState *g) {
+    int n = g->num_players;
+
+    // všetci, čo mieria do tej istej bunky, zomrú bez ohľadu na poradie
+    for (int i = 0; i < n; i++) {
+        int c = g->next_cell[i];
+        if (c < 0) continue;
+        int j = g->claim[c];
+        if (j < 0) {
+            g->claim[c] = i;
+        } else {
+            g->intent[j] = INTENT_HEAD_ON;
+            g->intent[i] = INTENT_HEAD_ON;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (g->next_cell[i] >= 0) g->claim[g->next_cell[i]] = -1;
+    }
+
+    // bunky mŕtvych a pohnutých sa neprekrývajú, poradie určuje len poradie vo free_cells
+    for (int i = 0; i < n; i++) {
+        uint8_t intent = g->intent[i];
+        if (intent == INTENT_MOVE || intent == INTENT_EAT) {
+            int c = g->next_cell[i];
+            // bez pamäte na dlhšie telo hadík len nevyrastie
+            int grow = (intent == INTENT_EAT && g->bodies[i].cap > (int)g->body_len[i]);
+            move_head(g, i, c % g->width, c / g->width, grow);
+            continue;
+        }
+        if (intent < INTENT_WALL) continue;
+
+        kill_snake(g, i);
+        switch (intent) {
+            case INTENT_WALL:     GAME_LOG("[SERVER] Hadík '%s' narazil do okraja!\n", g->players[i].name); break;
+            case INTENT_OBSTACLE: GAME_LOG("[SERVER] Hadík '%s' narazil do prekážky!\n", g->players[i].name); break;
+            case INTENT_SELF:     GAME_LOG("[SERVER] Hadík '%s' narazil sám do seba!\n", g->players[i].name); break;
+            case INTENT_OTHER:    GAME_LOG("[SERVER] Hadík '%s' narazil do iného hadíka!\n", g->players[i].name); break;
+            default:              GAME_LOG("[SERVER] Hadík '%s' sa zrazil hlavou!\n", g->players[i].name); break;
+        }
+    }
+
+    // ovocie až po všetkých pohyboch, aby nové nepadlo pod hlavu, ktorá sa ešte len pohne
+    for (int i = 0; i < n; i++) {
+        if (g->intent[i] != INTENT_EAT) continue;
+        for (int f = 0; f < g->num_fruits; f++) {
+            if (g->head_x[i] == g->fruits[f][0] && g->head_y[i] == g->fruits[f][1]) {
+                eat_fruit(g, i, f);
+                break;
+            }
+        }
+    }
+}
+
+// FNV-1a, po bajtoch
+static uint64_t hash_bytes(uint64_t h, const void *data, size_t n) {
+    const uint8_t *p = (const uint8_t*)data;
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+uint64_t game_hash(const GameState *g) {
+    int n = g->num_players;
+    int head[4] = { (int)g->tick, g->num_players, g->num_fruits, g->active | (g->game_over << 1) };
+
+    uint64_t h = 0xCBF29CE484222325ULL;
+    h = hash_bytes(h, head, sizeof(head));
+    h = hash_bytes(h, &g->rng, sizeof(g->rng));
+    h = hash_bytes(h, g->grid, (size_t)g->width * (size_t)g->height);
+    h = hash_bytes(h, g->head_x, (size_t)n * sizeof(g->head_x[0]));
+    h = hash_bytes(h, g->head_y, (size_t)n * sizeof(g->head_y[0]));
+    h = hash_bytes(h, g->pflags, (size_t)n * sizeof(g->pflags[0]));
+    h = hash_bytes(h, g->body_len, (size_t)n * sizeof(g->body_len[0]));
+    h = hash_bytes(h, g->input_seq, (size_t)n * sizeof(g->input_seq[0]));
+    for (int i = 0; i < n; i++) h = hash_bytes(h, &g->players[i].score, sizeof(g->players[i].score));
+    h = hash_bytes(h, g->fruits, (size_t)g->num_fruits * sizeof(g->fruits[0]));
+    return h;
+}
+
+void build_map(const GameState *g, char *out) {
+    int k = g->width * g->height;
+    memcpy(out, g->grid, (size_t)k);
+    out[k] = '\0';
+}
+
+GameTickResult game_tick(GameState *g) {
+    return game_tick_pool(g, NULL);
+}
+
+GameTickResult game_tick_pool(GameState *g, pool_t *pool) {
+    if (!g->active || g->num_players == 0 || g->game_over) return GAME_TICK_IDLE;
+
+    g->tick++;
+    g->elapsed_time = (int)(g->tick / (unsigned int)g->tick_rate);
+
+    if (g->mode == MODE_TIMED && g->elapsed_time >= g->time_limit) {
+        g->active = 0;
+        g->game_over = 1;
+        return GAME_TICK_TIME_UP;
+    }
+
+    if (g->tick_mode == TICK_TWO_PHASE) {
+        pool_run(pool, g->num_players, INTENT_CHUNK, intent_range, g);
+        resolve_tick(g);
+    } else {
+        for (int i = 0; i < g->num_players; i++) {
+            if (g->pflags[i] & PF_ALIVE) update_snake(g, i);
+        }
+    }
+    // doplň ovocie, ktoré sa predtým nezmestilo (alebo odober po smrti)
+    ensure_fruits_count(g);
+    return GAME_TICK_OK;
+}
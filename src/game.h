@@ -0,0 +1,54 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "snake.h"
+#include "pool.h"
+
+// pravidlá hry bez siete: server ich volá pod mutexom miestnosti, benchmark priamo
+
+// 0 = simulácia nič nepíše na stderr (benchmarky)
+extern int game_log;
+
+typedef enum {
+    GAME_TICK_IDLE,     // hra nebeží, nič sa nezmenilo
+    GAME_TICK_OK,
+    GAME_TICK_TIME_UP   // časový režim práve skončil
+} GameTickResult;
+
+// nová hra v g; pamäť z predošlej hry v tom istom g sa použije znova, -1 = nedostatok pamäte;
+// všetka náhoda v hre ide zo seed, rovnaký seed a rovnaké vstupy dajú bit po bite rovnakú hru
+int init_game(GameState *g, int width, int height, GameMode mode, int time_limit, WorldType world_type,
+              uint64_t seed);
+void game_free(GameState *g);
+// bajty, ktoré hra drží (GameState + všetky jeho polia)
+size_t game_memory(const GameState *g);
+
+// nový hadík na voľnom mieste, vráti player_id alebo -1; player_id je slot: g->num_players
+// (nový na konci) alebo slot mŕtveho hadíka, ktorý sa použije znova
+int init_snake(GameState *g, int player_id, const char *name);
+// to isté s danou počiatočnou dĺžkou (vodorovne, najviac šírka mapy)
+int spawn_snake(GameState *g, int player_id, const char *name, int len);
+// i je index hráča v poliach stavu (nie player_id)
+void kill_snake(GameState *g, int i);
+void update_snake(GameState *g, int i);
+
+int spawn_fruit_at(GameState *g, int idx);
+// počet ovocí podľa živých hadíkov
+void ensure_fruits_count(GameState *g);
+
+// jeden tick: čas, pohyb všetkých živých hadíkov (podľa g->tick_mode), ovocie
+GameTickResult game_tick(GameState *g);
+// to isté, fáza zámerov dvojfázového ticku ide cez pool (NULL = v tomto vlákne);
+// výsledok nezávisí od počtu vlákien
+GameTickResult game_tick_pool(GameState *g, pool_t *pool);
+
+// po odoslaní stavu sa začína zbierať nová delta
+void dirty_clear(GameState *g);
+
+// odtlačok stavu simulácie (mriežka, hadíky, skóre, ovocie, generátor) na kontrolu replaye
+uint64_t game_hash(const GameState *g);
+
+// mapa ako reťazec width * height znakov + '\0'
+void build_map(const GameState *g, char *out);
+
+#endif
@@ -0,0 +1,191 @@
+#include "journal.h"
+
+#define JOURNAL_MAGIC "HADJ"
+#define JOURNAL_BUFFER (64 * 1024)  // stdio buffer, do súboru sa píše pri odtlačkoch
+#define JOURNAL_MAX_RECORD 262      // najdlhší záznam (JOIN so slotom a menom do 255 bajtov)
+
+struct journal {
+    FILE *f;
+    unsigned int ticks;
+};
+
+static void w_u64(wbuf_t *w, uint64_t v) {
+    w_u32(w, (uint32_t)(v >> 32));
+    w_u32(w, (uint32_t)v);
+}
+
+static uint64_t r_u64(rbuf_t *r) {
+    uint64_t hi = r_u32(r);
+    return (hi << 32) | r_u32(r);
+}
+
+static void journal_put(journal_t *j, const wbuf_t *w) {
+    if (!w->err) fwrite(w->buf, 1, (size_t)w->len, j->f);
+}
+
+// ---------- ZÁPIS ----------
+
+journal_t* journal_create(const char *path, const GameState *g) {
+    journal_t *j = (journal_t*)calloc(1, sizeof(journal_t));
+    if (!j) return NULL;
+    j->f = fopen(path, "wb");
+    if (!j->f) {
+        free(j);
+        return NULL;
+    }
+    setvbuf(j->f, NULL, _IOFBF, JOURNAL_BUFFER);
+
+    uint8_t buf[JOURNAL_MAX_RECORD];
+    wbuf_t w;
+    wbuf_init(&w, buf, sizeof(buf));
+    w_bytes(&w, JOURNAL_MAGIC, 4);
+    w_u8(&w, JOURNAL_VERSION);
+    w_u64(&w, g->seed);
+    w_u32(&w, (uint32_t)g->id);
+    w_u16(&w, (uint32_t)g->width);
+    w_u16(&w, (uint32_t)g->height);
+    w_u8(&w, (uint32_t)g->mode);
+    w_u32(&w, (uint32_t)g->time_limit);
+    w_u8(&w, (uint32_t)g->world_type);
+    w_u16(&w, (uint32_t)g->tick_rate);
+    w_u8(&w, (uint32_t)g->tick_mode);
+    journal_put(j, &w);
+    return j;
+}
+
+void journal_close(journal_t *j) {
+    if (!j) return;
+    fclose(j->f);
+    free(j);
+}
+
+void journal_join(journal_t *j, int player, const char *name) {
+    if (!j) return;
+    uint8_t buf[JOURNAL_MAX_RECORD];
+    wbuf_t w;
+    wbuf_init(&w, buf, sizeof(buf));
+    w_u8(&w, JREC_JOIN);
+    w_u16(&w, (uint32_t)player);
+    w_str(&w, name);
+    journal_put(j, &w);
+}
+
+void journal_move(journal_t *j, int player, Direction dir, unsigned int seq) {
+    if (!j) return;
+    uint8_t buf[JOURNAL_MAX_RECORD];
+    wbuf_t w;
+    wbuf_init(&w, buf, sizeof(buf));
+    w_u8(&w, JREC_MOVE);
+    w_u16(&w, (uint32_t)player);
+    w_u8(&w, (uint32_t)dir);
+    w_u32(&w, seq);
+    journal_put(j, &w);
+}
+
+void journal_kill(journal_t *j, int player) {
+    if (!j) return;
+    uint8_t buf[JOURNAL_MAX_RECORD];
+    wbuf_t w;
+    wbuf_init(&w, buf, sizeof(buf));
+    w_u8(&w, JREC_KILL);
+    w_u16(&w, (uint32_t)player);
+    journal_put(j, &w);
+}
+
+void journal_tick(journal_t *j, const GameState *g) {
+    if (!j) return;
+    uint8_t buf[JOURNAL_MAX_RECORD];
+    wbuf_t w;
+    wbuf_init(&w, buf, sizeof(buf));
+    w_u8(&w, JREC_TICK);
+    if (++j->ticks % JOURNAL_HASH_EVERY == 0) {
+        w_u8(&w, JREC_HASH);
+        w_u32(&w, g->tick);
+        w_u64(&w, game_hash(g));
+    }
+    journal_put(j, &w);
+    // pri páde servera sa stratí najviac JOURNAL_HASH_EVERY tickov
+    if (j->ticks % JOURNAL_HASH_EVERY == 0) fflush(j->f);
+}
+
+// ---------- ČÍTANIE ----------
+
+int journal_reader_init(journal_reader_t *jr, const uint8_t *buf, int len, journal_config_t *cfg) {
+    rbuf_t *r = &jr->r;
+    rbuf_init(r, buf, len);
+    jr->truncated = 0;
+
+    if (len < 4 || memcmp(buf, JOURNAL_MAGIC, 4) != 0) return -1;
+    r->pos = 4;
+    if (r_u8(r) != JOURNAL_VERSION) return -1;
+    cfg->seed = r_u64(r);
+    cfg->room_id = (int)r_u32(r);
+    cfg->width = (int)r_u16(r);
+    cfg->height = (int)r_u16(r);
+    cfg->mode = (GameMode)r_u8(r);
+    cfg->time_limit = (int)r_u32(r);
+    cfg->world_type = (WorldType)r_u8(r);
+    cfg->tick_rate = (int)r_u16(r);
+    cfg->tick_mode = (TickMode)r_u8(r);
+    return r->err ? -1 : 0;
+}
+
+int journal_read(journal_reader_t *jr, journal_rec_t *rec) {
+    rbuf_t *r = &jr->r;
+    if (r->pos >= r->len) return 0;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->type = (JournalRecord)r_u8(r);
+    switch (rec->type) {
+        case JREC_TICK:
+            break;
+        case JREC_JOIN:
+            rec->player = (int)r_u16(r);
+            r_str(r, rec->name, sizeof(rec->name));
+            break;
+        case JREC_MOVE:
+            rec->player = (int)r_u16(r);
+            rec->dir = (Direction)r_u8(r);
+            rec->seq = r_u32(r);
+            break;
+        case JREC_KILL:
+            rec->player = (int)r_u16(r);
+            break;
+        case JREC_HASH:
+            rec->tick = r_u32(r);
+            rec->hash = r_u64(r);
+            break;
+        default:
+            return -1;
+    }
+    if (r->err) {
+        jr->truncated = 1;
+        return 0;
+    }
+    return 1;
+}
+
+void journal_apply(GameState *g, const journal_rec_t *rec, pool_t *pool) {
+    switch (rec->type) {
+        case JREC_TICK:
+            game_tick_pool(g, pool);
+            break;
+        case JREC_JOIN:
+            init_snake(g, rec->player, rec->name);
+            break;
+        case JREC_MOVE:
+            if (rec->player < g->num_players && (unsigned)rec->dir <= NONE) {
+                player_set_next_dir(g, rec->player, rec->dir);
+                if (rec->seq) g->next_seq[rec->player] = rec->seq;
+            }
+            break;
+        case JREC_KILL:
+            if (rec->player < g->num_players) {
+                kill_snake(g, rec->player);
+                ensure_fruits_count(g);
+            }
+            break;
+        case JREC_HASH:
+            break;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "game.h"
+#include "proto.h"
+
+// žurnál hry: hlavička so seedom a nastavením miestnosti, potom záznamy v poradí, v akom
+// ich server použil na stav (pod mutexom miestnosti). Zo žurnálu sa dá hra odsimulovať znova
+// (make replay) a každých JOURNAL_HASH_EVERY tickov skontrolovať odtlačok stavu.
+//
+// Súbor je len na pripisovanie, čísla big-endian ako v protokole (u64 = dve u32):
+//   hlavička: "HADJ", u8 verzia, u64 seed, u32 id miestnosti, u16 šírka, u16 výška, u8 režim,
+//             u32 time_limit, u8 svet, u16 tick_rate, u8 tick_mode
+//   záznamy:  u8 typ + telo podľa typu (JREC_*); orezaný posledný záznam (pád servera) je koniec
+
+#define JOURNAL_VERSION 2
+#define JOURNAL_HASH_EVERY 16   // tickov medzi odtlačkami stavu
+
+typedef enum {
+    JREC_TICK = 1,      // game_tick, ktorý nebol IDLE
+    JREC_JOIN = 2,      // u16 slot, u8 dĺžka, meno: init_snake(g, slot, meno)
+    JREC_MOVE = 3,      // u16 hráč, u8 smer, u32 input_seq: prijatý MOVE
+    JREC_KILL = 4,      // u16 hráč: odchod alebo QUIT (kill_snake + ensure_fruits_count)
+    JREC_HASH = 5       // u32 tick, u64 game_hash po ňom
+} JournalRecord;
+
+typedef struct {
+    uint64_t seed;
+    int room_id;
+    int width;
+    int height;
+    GameMode mode;
+    int time_limit;
+    WorldType world_type;
+    int tick_rate;
+    TickMode tick_mode;
+} journal_config_t;
+
+typedef struct {
+    JournalRecord type;
+    int player;
+    Direction dir;
+    unsigned int seq;
+    unsigned int tick;
+    uint64_t hash;
+    char name[50];
+} journal_rec_t;
+
+// ---------- ZÁPIS ----------
+
+typedef struct journal journal_t;
+
+// nový žurnál s nastavením hry g (po init_game, tick_rate a tick_mode), NULL pri chybe
+journal_t* journal_create(const char *path, const GameState *g);
+void journal_close(journal_t *j);
+
+// všetky prijímajú j == NULL (miestnosť bez žurnálu)
+void journal_join(journal_t *j, int player, const char *name);
+void journal_move(journal_t *j, int player, Direction dir, unsigned int seq);
+void journal_kill(journal_t *j, int player);
+// po ticku; každých JOURNAL_HASH_EVERY tickov pridá odtlačok a vyprázdni buffer do súboru
+void journal_tick(journal_t *j, const GameState *g);
+
+// ---------- ČÍTANIE ----------
+
+typedef struct {
+    rbuf_t r;
+    int truncated;      // koniec bol uprostred záznamu
+} journal_reader_t;
+
+// skontroluje hlavičku, -1 = nie je to žurnál (alebo iná verzia)
+int journal_reader_init(journal_reader_t *r, const uint8_t *buf, int len, journal_config_t *cfg);
+// 1 = záznam v rec, 0 = koniec, -1 = neznámy typ záznamu
+int journal_read(journal_reader_t *r, journal_rec_t *rec);
+
+// vykoná záznam nad g (JREC_HASH nič nemení); rovnako ako server
+void journal_apply(GameState *g, const journal_rec_t *rec, pool_t *pool);
+
+#endif
@@ -0,0 +1,79 @@
+#define _POSIX_C_SOURCE 200809L
+#include "metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void mtext_init(mtext_t *t) {
+    t->buf = NULL;
+    t->len = 0;
+    t->cap = 0;
+    t->err = 0;
+}
+
+void mtext_free(mtext_t *t) {
+    free(t->buf);
+    mtext_init(t);
+}
+
+void mtext_printf(mtext_t *t, const char *fmt, ...) {
+    if (t->err) return;
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(t->buf ? t->buf + t->len : NULL, (size_t)(t->cap - t->len), fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            t->err = 1;
+            return;
+        }
+        if (t->len + n < t->cap) {
+            t->len += n;
+            return;
+        }
+
+        int ncap = t->cap ? t->cap * 2 : 4096;
+        while (ncap <= t->len + n) ncap *= 2;
+        char *nb = (char*)realloc(t->buf, (size_t)ncap);
+        if (!nb) {
+            t->err = 1;
+            return;
+        }
+        t->buf = nb;
+        t->cap = ncap;
+    }
+}
+
+void metrics_header(mtext_t *t, const char *name, const char *type, const char *help) {
+    mtext_printf(t, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void metrics_value(mtext_t *t, const char *name, const char *labels, double v) {
+    if (labels) mtext_printf(t, "%s{%s} %.15g\n", name, labels, v);
+    else mtext_printf(t, "%s %.15g\n", name, v);
+}
+
+void metrics_hist(mtext_t *t, const char *name, const char *labels, const metrics_hist_t *h, int lo, double scale) {
+    const char *sep = labels ? "," : "";
+    if (!labels) labels = "";
+
+    // _count je súčet košov, aby sedel s +Inf aj keď sa medzitým zapisuje
+    uint64_t cum = 0;
+    for (int i = 0; i < METRICS_BUCKETS; i++) {
+        cum += metrics_get(&h->bucket[i]);
+        if (i < METRICS_BUCKETS - 1) {
+            mtext_printf(t, "%s_bucket{%s%sle=\"%.9g\"} %llu\n", name, labels, sep,
+                         (double)(1ULL << (lo + i)) / scale, (unsigned long long)cum);
+        } else {
+            mtext_printf(t, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, sep, (unsigned long long)cum);
+        }
+    }
+    double sum = (double)metrics_get(&h->sum) / scale;
+    if (*labels) {
+        mtext_printf(t, "%s_sum{%s} %.15g\n%s_count{%s} %llu\n", name, labels, sum, name, labels,
+                     (unsigned long long)cum);
+    } else {
+        mtext_printf(t, "%s_sum %.15g\n%s_count %llu\n", name, sum, name, (unsigned long long)cum);
+    }
+}
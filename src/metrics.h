@@ -0,0 +1,86 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+// telemetria servera: počítadlá a histogramy sa zapisujú atomickými inštrukciami bez zámkov
+// (relaxed, jednotky ns), takže môžu byť zapnuté stále. Čítanie (admin socket) berie hodnoty
+// jednu po druhej, snímok teda nie je presne súčasný, čo textovému formátu Promethea stačí.
+
+// koše histogramu sú mocniny dvojky: kôš i má hornú hranicu 2^(lo + i), posledný je +Inf
+#define METRICS_BUCKETS 24
+#define METRICS_NS_LO 10        // časy od ~1 µs po ~4 s
+
+typedef struct {
+    uint64_t bucket[METRICS_BUCKETS];
+    uint64_t sum;
+} metrics_hist_t;
+
+static inline void metrics_add(uint64_t *counter, uint64_t v) {
+    __atomic_fetch_add(counter, v, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t metrics_get(const uint64_t *counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void metrics_observe_lo(metrics_hist_t *h, int lo, uint64_t v) {
+    int k = 0;
+    if (v > (1ULL << lo)) {
+        k = 64 - __builtin_clzll(v - 1) - lo;   // ceil(log2 v) - lo
+        if (k > METRICS_BUCKETS - 1) k = METRICS_BUCKETS - 1;
+    }
+    metrics_add(&h->bucket[k], 1);
+    metrics_add(&h->sum, v);
+}
+
+// počty (bajty, rámce), koše 1, 2, 4, ...
+static inline void metrics_observe(metrics_hist_t *h, uint64_t v) {
+    metrics_observe_lo(h, 0, v);
+}
+
+// trvanie od t0 (metrics_now_ns)
+static inline void metrics_observe_since(metrics_hist_t *h, uint64_t t0) {
+    metrics_observe_lo(h, METRICS_NS_LO, metrics_now_ns() - t0);
+}
+
+// zamkne mtx; hodiny sa volajú, len keď je zámok obsadený, voľný sa zapíše ako nulové čakanie
+static inline void metrics_lock(pthread_mutex_t *mtx, metrics_hist_t *wait) {
+    if (pthread_mutex_trylock(mtx) == 0) {
+        metrics_observe_lo(wait, METRICS_NS_LO, 0);
+        return;
+    }
+    uint64_t t0 = metrics_now_ns();
+    pthread_mutex_lock(mtx);
+    metrics_observe_since(wait, t0);
+}
+
+// ---------- TEXTOVÝ FORMÁT ----------
+
+typedef struct {
+    char *buf;
+    int len;
+    int cap;
+    int err;        // nedostatok pamäte, text je neúplný
+} mtext_t;
+
+void mtext_init(mtext_t *t);
+void mtext_free(mtext_t *t);
+void mtext_printf(mtext_t *t, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// # HELP a # TYPE pred prvou vzorkou metriky
+void metrics_header(mtext_t *t, const char *name, const char *type, const char *help);
+// jedna vzorka; labels bez zátvoriek ("room=\"3\""), NULL = bez nich
+void metrics_value(mtext_t *t, const char *name, const char *labels, double v);
+// koše (kumulatívne), _sum a _count; scale delí hranice aj súčet (1e9 = ns na sekundy)
+void metrics_hist(mtext_t *t, const char *name, const char *labels, const metrics_hist_t *h, int lo, double scale);
+
+#endif
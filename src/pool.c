@@ -0,0 +1,131 @@
+#include "pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+struct pool {
+    pthread_mutex_t run_mtx;    // jedna úloha naraz, ďalší volajúci to spravia sami
+    pthread_mutex_t mtx;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    pthread_t *threads;
+    int num_threads;
+    int stop;
+    unsigned long gen;          // číslo úlohy, pomocník čaká na nové
+
+    // aktuálna úloha
+    pool_fn fn;
+    void *ctx;
+    int n;
+    int chunks;
+    int next_chunk;             // ďalší nerozdaný úsek (atomicky)
+    int pending;                // pomocníci, ktorí úlohu ešte nedokončili
+};
+
+static void run_chunks(pool_t *p) {
+    for (;;) {
+        int k = __atomic_fetch_add(&p->next_chunk, 1, __ATOMIC_RELAXED);
+        if (k >= p->chunks) return;
+        int from = (int)((long long)p->n * k / p->chunks);
+        int to = (int)((long long)p->n * (k + 1) / p->chunks);
+        p->fn(p->ctx, from, to);
+    }
+}
+
+static void* pool_worker(void *arg) {
+    pool_t *p = (pool_t*)arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&p->mtx);
+    for (;;) {
+        while (!p->stop && p->gen == seen) pthread_cond_wait(&p->work, &p->mtx);
+        if (p->stop) break;
+        seen = p->gen;
+        pthread_mutex_unlock(&p->mtx);
+
+        run_chunks(p);
+
+        pthread_mutex_lock(&p->mtx);
+        if (--p->pending == 0) pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->mtx);
+    return NULL;
+}
+
+pool_t* pool_create(int threads) {
+    if (threads < 1) return NULL;
+
+    pool_t *p = (pool_t*)calloc(1, sizeof(pool_t));
+    if (!p) return NULL;
+    p->threads = (pthread_t*)calloc((size_t)threads, sizeof(pthread_t));
+    if (!p->threads) {
+        free(p);
+        return NULL;
+    }
+    pthread_mutex_init(&p->run_mtx, NULL);
+    pthread_mutex_init(&p->mtx, NULL);
+    pthread_cond_init(&p->work, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&p->threads[i], NULL, pool_worker, p) != 0) break;
+        p->num_threads++;
+    }
+    if (p->num_threads == 0) {
+        pool_free(p);
+        return NULL;
+    }
+    return p;
+}
+
+void pool_free(pool_t *p) {
+    if (!p) return;
+
+    pthread_mutex_lock(&p->mtx);
+    p->stop = 1;
+    pthread_cond_broadcast(&p->work);
+    pthread_mutex_unlock(&p->mtx);
+    for (int i = 0; i < p->num_threads; i++) pthread_join(p->threads[i], NULL);
+
+    pthread_mutex_destroy(&p->run_mtx);
+    pthread_mutex_destroy(&p->mtx);
+    pthread_cond_destroy(&p->work);
+    pthread_cond_destroy(&p->done);
+    free(p->threads);
+    free(p);
+}
+
+int pool_threads(const pool_t *p) {
+    return p ? p->num_threads : 0;
+}
+
+void pool_run(pool_t *p, int n, int min_chunk, pool_fn fn, void *ctx) {
+    if (n <= 0) return;
+    if (min_chunk < 1) min_chunk = 1;
+
+    int chunks = p ? n / min_chunk : 1;
+    if (p && chunks > p->num_threads + 1) chunks = p->num_threads + 1;
+    if (chunks <= 1 || pthread_mutex_trylock(&p->run_mtx) != 0) {
+        fn(ctx, 0, n);
+        return;
+    }
+
+    pthread_mutex_lock(&p->mtx);
+    p->fn = fn;
+    p->ctx = ctx;
+    p->n = n;
+    p->chunks = chunks;
+    p->next_chunk = 0;
+    p->pending = p->num_threads;
+    p->gen++;
+    pthread_cond_broadcast(&p->work);
+    pthread_mutex_unlock(&p->mtx);
+
+    run_chunks(p);
+
+    pthread_mutex_lock(&p->mtx);
+    while (p->pending > 0) pthread_cond_wait(&p->done, &p->mtx);
+    pthread_mutex_unlock(&p->mtx);
+
+    pthread_mutex_unlock(&p->run_mtx);
+}
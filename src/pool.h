@@ -0,0 +1,21 @@
+#ifndef POOL_H
+#define POOL_H
+
+// malý pool vlákien pre dátovo paralelné cykly (fáza zámerov v dvojfázovom ticku):
+// pool_run rozdelí [0, n) na súvislé úseky a čaká, kým ich pomocníci aj volajúci spracujú
+
+typedef struct pool pool_t;
+
+// spracuje prvky [from, to); úseky sa neprekrývajú, fn nesmie zapisovať mimo svojich prvkov
+typedef void (*pool_fn)(void *ctx, int from, int to);
+
+// threads pomocných vlákien (volajúci počíta s nimi), NULL pri chybe
+pool_t* pool_create(int threads);
+void pool_free(pool_t *p);
+int pool_threads(const pool_t *p);
+
+// úseky majú aspoň min_chunk prvkov; bez poolu, pri malom n alebo keď pool práve
+// pracuje pre iné vlákno, prejde volajúci celé [0, n) sám
+void pool_run(pool_t *p, int n, int min_chunk, pool_fn fn, void *ctx);
+
+#endif
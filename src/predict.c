@@ -0,0 +1,226 @@
+#include "predict.h"
+
+// ako rýchlo sa hodiny prispôsobia oneskoreniu stavov (zvyšok vyhladí jitter)
+#define CLOCK_SMOOTH 0.125
+// odhad oneskorenia sklzne hneď nadol, nahor len pomaly (vzorky obsahujú aj čakanie na tick)
+#define LAG_RISE 0.05
+// server spraví jeden vstup za tick, k-ty nepotvrdený v poradí teda o k tickov neskôr; čo nepotvrdí
+// ani po oneskorení a ďalších toľkých tickoch (plus rezerva), zahodil (plná schránka, nový hadík)
+#define INPUT_LOST_TICKS 2
+#define INPUT_LOST_SEC 0.25
+
+void predict_reset(predict_t *p) {
+    memset(p, 0, sizeof(*p));
+}
+
+unsigned int predict_input(predict_t *p, Direction dir, double now) {
+    // 0 znamená "bez poradového čísla"
+    if (++p->next_seq == 0) p->next_seq = 1;
+
+    if (p->num_pending == PREDICT_MAX_PENDING) {
+        p->pending_head = (p->pending_head + 1) % PREDICT_MAX_PENDING;
+        p->num_pending--;
+    }
+    pred_input_t *in = &p->pending[(p->pending_head + p->num_pending) % PREDICT_MAX_PENDING];
+    in->seq = p->next_seq;
+    in->dir = dir;
+    in->sent = now;
+    p->num_pending++;
+    return p->next_seq;
+}
+
+// k = poradie medzi nepotvrdenými vstupmi (0 = najstarší)
+static int input_lost(const predict_t *p, int k, double now) {
+    const pred_input_t *in = &p->pending[(p->pending_head + k) % PREDICT_MAX_PENDING];
+    return now - in->sent > p->lag + (k + INPUT_LOST_TICKS) * p->period + INPUT_LOST_SEC;
+}
+
+int predict_pending_dir(const predict_t *p, double now, Direction *dir) {
+    int k = p->num_pending - 1;
+    if (k < 0 || input_lost(p, k, now)) return 0;
+    *dir = p->pending[(p->pending_head + k) % PREDICT_MAX_PENDING].dir;
+    return 1;
+}
+
+static int adjacent(const GameState *g, int x0, int y0, int x1, int y1) {
+    int dx = abs(x1 - x0), dy = abs(y1 - y0);
+    if (g->world_type == WORLD_NO_OBSTACLES) {
+        if (dx > g->width / 2) dx = g->width - dx;
+        if (dy > g->height / 2) dy = g->height - dy;
+    }
+    return dx + dy == 1;
+}
+
+static void trail_push(predict_t *p, int x, int y) {
+    p->trail_head = (p->trail_head + 1) % PREDICT_TRAIL;
+    p->trail_x[p->trail_head] = x;
+    p->trail_y[p->trail_head] = y;
+    if (p->trail_len < PREDICT_TRAIL) p->trail_len++;
+}
+
+// k-ta bunka stopy od hlavy (0 = hlava)
+static int trail_back(const predict_t *p, int k, int *x, int *y) {
+    if (k < 0 || k >= p->trail_len) return 0;
+    int i = (p->trail_head - k + PREDICT_TRAIL) % PREDICT_TRAIL;
+    *x = p->trail_x[i];
+    *y = p->trail_y[i];
+    return 1;
+}
+
+void predict_server_state(predict_t *p, const GameState *g, int player_id, double now) {
+    if (player_id < 0 || player_id >= g->num_players || g->tick_rate <= 0) {
+        p->have_base = 0;
+        p->trail_len = 0;
+        return;
+    }
+    unsigned int acked = g->input_seq[player_id];
+    int head_x = g->head_x[player_id], head_y = g->head_y[player_id];
+
+    // vstupy, ktoré už tick spracoval, sú v stave servera
+    while (p->num_pending > 0 && acked &&
+           (int)(p->pending[p->pending_head].seq - acked) <= 0) {
+        const pred_input_t *in = &p->pending[p->pending_head];
+        if (in->seq == acked) {
+            double lag = now - in->sent;
+            if (!p->have_lag || lag < p->lag) p->lag = lag;
+            else p->lag += (lag - p->lag) * LAG_RISE;
+            p->have_lag = 1;
+        }
+        p->pending_head = (p->pending_head + 1) % PREDICT_MAX_PENDING;
+        p->num_pending--;
+    }
+    while (p->num_pending > 0 && input_lost(p, 0, now)) {
+        p->pending_head = (p->pending_head + 1) % PREDICT_MAX_PENDING;
+        p->num_pending--;
+    }
+
+    // stopa tela; po preskočených stavoch sa nedá nadviazať a začne sa znova
+    int hx, hy;
+    if (!player_alive(g, player_id)) {
+        p->trail_len = 0;
+    } else if (trail_back(p, 0, &hx, &hy) && hx == head_x && hy == head_y) {
+        // hadík stojí (rovnaký tick)
+    } else if (p->trail_len > 0 && adjacent(g, hx, hy, head_x, head_y)) {
+        trail_push(p, head_x, head_y);
+    } else {
+        p->trail_len = 0;
+        trail_push(p, head_x, head_y);
+    }
+
+    double period = 1.0 / g->tick_rate;
+    double err = now - (p->origin + (double)g->tick * p->period);
+    if (!p->have_base || period != p->period || g->tick < p->base_tick || err > period || err < -period) {
+        p->origin = now - (double)g->tick * period;
+    } else {
+        p->origin += err * CLOCK_SMOOTH;
+    }
+    p->period = period;
+    p->base_tick = g->tick;
+    p->have_base = 1;
+}
+
+// čas, kedy by mal prísť posledný stav
+static double base_time(const predict_t *p) {
+    return p->origin + (double)p->base_tick * p->period;
+}
+
+// o koľko tickov je vlastný hadík pred posledným stavom: oneskorenie vstupov + meškajúci stav
+static int predicted_ticks(const predict_t *p, double now) {
+    double since = now - base_time(p) + p->lag;
+    if (since < 0) return 0;
+    int k = (int)(since / p->period);
+    return (k > PREDICT_MAX_TICKS) ? PREDICT_MAX_TICKS : k;
+}
+
+double predict_wait(const predict_t *p, double now) {
+    if (!p->have_base || p->trail_len == 0) return -1;
+    int k = predicted_ticks(p, now);
+    if (k >= PREDICT_MAX_TICKS) return -1;
+    double next = base_time(p) + (k + 1) * p->period - p->lag;
+    return (next > now) ? next - now : 0;
+}
+
+static int in_rect(const ViewRect *v, int x, int y) {
+    return x >= v->x && x < v->x + v->w && y >= v->y && y < v->y + v->h;
+}
+
+void predict_apply(const predict_t *p, const GameState *g, int player_id, char *view, const ViewRect *v,
+                   double now) {
+    if (!p->have_base || player_id < 0 || player_id >= g->num_players) return;
+    if (!g->active || g->game_over) return;
+
+    int x, y;
+    if (!player_alive(g, player_id) || !trail_back(p, 0, &x, &y) ||
+        x != g->head_x[player_id] || y != g->head_y[player_id] || !in_rect(v, x, y)) {
+        return;
+    }
+
+    int steps = predicted_ticks(p, now);
+    if (steps == 0) return;
+
+    // predikované bunky hlavy, pred nimi je stopa zo stavov
+    int px[PREDICT_MAX_TICKS], py[PREDICT_MAX_TICKS], np = 0;
+    int len = (int)g->body_len[player_id];
+    int w = g->width;
+    Direction dir = player_dir(g, player_id);
+    double t0 = base_time(p) - p->lag;
+    int next = 0;
+
+    for (int s = 1; s <= steps; s++) {
+        // server spraví najviac jednu otočku za tick: ďalší vstup v poradí, ak ho k ticku stihne dostať
+        double at = t0 + s * p->period;
+        if (next < p->num_pending) {
+            const pred_input_t *in = &p->pending[(p->pending_head + next) % PREDICT_MAX_PENDING];
+            if (in->sent <= at) {
+                dir = in->dir;
+                next++;
+            }
+        }
+
+        int nx = x, ny = y;
+        switch (dir) {
+            case UP:    ny--; break;
+            case DOWN:  ny++; break;
+            case LEFT:  nx--; break;
+            case RIGHT: nx++; break;
+            case NONE:  return;
+        }
+        if (g->world_type == WORLD_NO_OBSTACLES) {
+            nx = (nx + g->width) % g->width;
+            ny = (ny + g->height) % g->height;
+        } else if (nx < 0 || ny < 0 || nx >= g->width || ny >= g->height) {
+            return;
+        }
+        // mimo výrezu view nemá aktuálny obsah
+        if (!in_rect(v, nx, ny)) return;
+
+        // chvost, ktorý sa v tomto ticku uvoľní (ak ho poznáme)
+        int tx = -1, ty = -1, k = len - 1, have_tail = 1;
+        if (k < np) {
+            tx = px[np - 1 - k];
+            ty = py[np - 1 - k];
+        } else {
+            have_tail = trail_back(p, k - np, &tx, &ty);
+        }
+
+        // smrť sa nepredikuje, o tej rozhodne server
+        char target = view[ny * w + nx];
+        int grow = (target == CELL_FRUIT);
+        if (target == CELL_OBSTACLE) return;
+        if ((target == CELL_BODY || target == CELL_HEAD) && !(have_tail && tx == nx && ty == ny)) return;
+
+        if (grow) {
+            len++;
+        } else if (have_tail && in_rect(v, tx, ty)) {
+            view[ty * w + tx] = CELL_EMPTY;
+        }
+        if (len > 1) view[y * w + x] = CELL_BODY;
+        view[ny * w + nx] = CELL_HEAD;
+
+        px[np] = nx;
+        py[np] = ny;
+        np++;
+        x = nx;
+        y = ny;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef PREDICT_H
+#define PREDICT_H
+
+#include "proto.h"
+
+// lokálna predikcia vlastného hadíka: medzi stavmi servera sa hadík posúva podľa
+// vlastných hodín tickov a vstupov, ktoré server ešte nepotvrdil (input_seq v stave)
+
+#define PREDICT_MAX_PENDING 64
+#define PREDICT_MAX_TICKS 3     // ďalej dopredu sa nehádže, chyba by bola priveľká
+#define PREDICT_TRAIL 1024      // dlhšiemu hadíkovi predikcia nemaže chvost
+
+typedef struct {
+    unsigned int seq;
+    Direction dir;
+    double sent;
+} pred_input_t;
+
+typedef struct {
+    unsigned int next_seq;
+    pred_input_t pending[PREDICT_MAX_PENDING];     // kruhový, najstarší na pending_head
+    int pending_head;
+    int num_pending;
+
+    // bunky vlastného tela z po sebe idúcich stavov, hlava je posledná
+    int trail_x[PREDICT_TRAIL];
+    int trail_y[PREDICT_TRAIL];
+    int trail_head;
+    int trail_len;
+
+    // hodiny tickov: stav s tickom t sa čaká v čase origin + t * period (vyhladené)
+    int have_base;
+    unsigned int base_tick;
+    double origin;
+    double period;
+
+    // čas od odoslania vstupu po prvý stav, ktorý ho potvrdil (~RTT), o toľko sa kreslí dopredu
+    double lag;
+    int have_lag;
+} predict_t;
+
+void predict_reset(predict_t *p);
+
+// zaznamená odosielaný vstup, vráti jeho input_seq
+unsigned int predict_input(predict_t *p, Direction dir, double now);
+
+// smer posledného vstupu, ktorý server ešte nepotvrdil a nepovažuje sa za stratený; 0 = taký nie je
+int predict_pending_dir(const predict_t *p, double now, Direction *dir);
+
+// nový autoritatívny stav: zahodí potvrdené vstupy, posunie stopu a hodiny
+void predict_server_state(predict_t *p, const GameState *g, int player_id, double now);
+
+// prekreslí vlastného hadíka vo view (kópia g->grid, riadok má g->width buniek) o predikované ticky;
+// platné sú len bunky v obdĺžniku v, za ním sa predikcia zastaví
+void predict_apply(const predict_t *p, const GameState *g, int player_id, char *view, const ViewRect *v,
+                   double now);
+
+// sekundy do najbližšieho predikovaného ticku, < 0 = nepredikuje sa
+double predict_wait(const predict_t *p, double now);
+
+#endif
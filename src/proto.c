@@ -0,0 +1,873 @@
+#include "proto.h"
+
+// ---------- ZÁPIS / ČÍTANIE ----------
+
+void wbuf_init(wbuf_t *w, void *buf, int cap) {
+    w->buf = (uint8_t*)buf;
+    w->cap = cap;
+    w->len = 0;
+    w->err = 0;
+}
+
+static int w_room(wbuf_t *w, int n) {
+    if (w->err || w->len + n > w->cap) {
+        w->err = 1;
+        return 0;
+    }
+    return 1;
+}
+
+void w_u8(wbuf_t *w, uint32_t v) {
+    if (!w_room(w, 1)) return;
+    w->buf[w->len++] = (uint8_t)v;
+}
+
+void w_u16(wbuf_t *w, uint32_t v) {
+    if (!w_room(w, 2)) return;
+    w->buf[w->len++] = (uint8_t)(v >> 8);
+    w->buf[w->len++] = (uint8_t)v;
+}
+
+void w_u32(wbuf_t *w, uint32_t v) {
+    if (!w_room(w, 4)) return;
+    w->buf[w->len++] = (uint8_t)(v >> 24);
+    w->buf[w->len++] = (uint8_t)(v >> 16);
+    w->buf[w->len++] = (uint8_t)(v >> 8);
+    w->buf[w->len++] = (uint8_t)v;
+}
+
+void w_bytes(wbuf_t *w, const void *p, int n) {
+    if (!w_room(w, n)) return;
+    memcpy(w->buf + w->len, p, (size_t)n);
+    w->len += n;
+}
+
+// reťazec = u8 dĺžka + bajty
+void w_str(wbuf_t *w, const char *s) {
+    size_t n = strlen(s);
+    if (n > 255) n = 255;
+    w_u8(w, (uint32_t)n);
+    w_bytes(w, s, (int)n);
+}
+
+void rbuf_init(rbuf_t *r, const void *buf, int len) {
+    r->buf = (const uint8_t*)buf;
+    r->len = len;
+    r->pos = 0;
+    r->err = 0;
+}
+
+static int r_room(rbuf_t *r, int n) {
+    if (r->err || r->pos + n > r->len) {
+        r->err = 1;
+        return 0;
+    }
+    return 1;
+}
+
+uint32_t r_u8(rbuf_t *r) {
+    if (!r_room(r, 1)) return 0;
+    return r->buf[r->pos++];
+}
+
+uint32_t r_u16(rbuf_t *r) {
+    if (!r_room(r, 2)) return 0;
+    uint32_t v = ((uint32_t)r->buf[r->pos] << 8) | r->buf[r->pos + 1];
+    r->pos += 2;
+    return v;
+}
+
+uint32_t r_u32(rbuf_t *r) {
+    if (!r_room(r, 4)) return 0;
+    const uint8_t *b = r->buf + r->pos;
+    r->pos += 4;
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+void r_str(rbuf_t *r, char *out, int cap) {
+    int n = (int)r_u8(r);
+    if (!r_room(r, n)) {
+        out[0] = '\0';
+        return;
+    }
+    int k = (n < cap - 1) ? n : cap - 1;
+    memcpy(out, r->buf + r->pos, (size_t)k);
+    out[k] = '\0';
+    r->pos += n;
+}
+
+// ---------- RÁMCE ----------
+
+int proto_frame_begin(wbuf_t *w, MessageType type) {
+    int start = w->len;
+    w_u32(w, 0);
+    w_u8(w, (uint32_t)type);
+    return start;
+}
+
+void proto_frame_end(wbuf_t *w, int start) {
+    if (w->err) return;
+    uint32_t n = (uint32_t)(w->len - start - 4);
+    w->buf[start]     = (uint8_t)(n >> 24);
+    w->buf[start + 1] = (uint8_t)(n >> 16);
+    w->buf[start + 2] = (uint8_t)(n >> 8);
+    w->buf[start + 3] = (uint8_t)n;
+}
+
+int proto_frame_peek(const uint8_t *buf, int len, MessageType *type, int *payload_len) {
+    if (len < PROTO_HEADER_SIZE) return 0;
+
+    uint32_t n = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3];
+    if (n < 1 || n > PROTO_MAX_FRAME) return -1;
+    if ((uint32_t)len < 4 + n) return 0;
+
+    *type = (MessageType)buf[4];
+    *payload_len = (int)n - 1;
+    return 1;
+}
+
+int proto_encode_u32(MessageType type, uint32_t value, wbuf_t *w) {
+    int start = proto_frame_begin(w, type);
+    w_u32(w, value);
+    proto_frame_end(w, start);
+    return w->err ? -1 : 0;
+}
+
+// ---------- PRÍKAZY ----------
+
+int proto_encode_cmd(const Message *m, wbuf_t *w) {
+    int start = proto_frame_begin(w, m->type);
+
+    switch (m->type) {
+        case MSG_NEW_GAME:
+            w_u8(w, (uint32_t)m->args[0]);
+            w_u8(w, (uint32_t)m->args[1]);
+            w_u32(w, (uint32_t)m->args[2]);
+            w_u16(w, (uint32_t)m->args[3]);
+            w_u16(w, (uint32_t)m->args[4]);
+            w_u16(w, (uint32_t)m->args[5]);
+            w_u8(w, (uint32_t)m->args[6]);
+            break;
+        case MSG_PLAYER_NAME:
+            w_str(w, m->data);
+            break;
+        case MSG_MOVE:
+            w_u16(w, (uint32_t)m->player_id);
+            w_u8(w, (uint32_t)m->direction);
+            w_u32(w, m->input_seq);
+            break;
+        case MSG_QUIT:
+            w_u16(w, (uint32_t)m->player_id);
+            break;
+        case MSG_JOIN_GAME:
+            w_u32(w, (uint32_t)m->game_id);
+            break;
+        case MSG_HELLO:
+            w_u8(w, (uint32_t)m->args[0]);
+            break;
+        case MSG_VIEW:
+            w_u16(w, (uint32_t)m->args[0]);
+            w_u16(w, (uint32_t)m->args[1]);
+            break;
+        default:
+            break;
+    }
+
+    proto_frame_end(w, start);
+    return w->err ? -1 : 0;
+}
+
+int proto_decode_cmd(MessageType type, const uint8_t *payload, int len, Message *m) {
+    rbuf_t r;
+    rbuf_init(&r, payload, len);
+    memset(m, 0, sizeof(*m));
+    m->type = type;
+
+    switch (type) {
+        case MSG_NEW_GAME:
+            m->args[0] = (int)r_u8(&r);
+            m->args[1] = (int)r_u8(&r);
+            m->args[2] = (int)r_u32(&r);
+            m->args[3] = (int)r_u16(&r);
+            m->args[4] = (int)r_u16(&r);
+            // tick_rate je nepovinný, 0 = predvolený servera
+            m->args[5] = (r.pos < r.len) ? (int)r_u16(&r) : 0;
+            // tick_mode tiež, 0 = po poradí
+            m->args[6] = (r.pos < r.len) ? (int)r_u8(&r) : 0;
+            break;
+        case MSG_PLAYER_NAME:
+            r_str(&r, m->data, 50);
+            break;
+        case MSG_MOVE:
+            m->player_id = (int)r_u16(&r);
+            m->direction = (Direction)r_u8(&r);
+            // poradové číslo je nepovinné, 0 = klient nepredikuje
+            m->input_seq = (r.pos < r.len) ? r_u32(&r) : 0;
+            break;
+        case MSG_QUIT:
+            m->player_id = (int)r_u16(&r);
+            break;
+        case MSG_JOIN_GAME:
+            m->game_id = (int)r_u32(&r);
+            break;
+        case MSG_HELLO:
+            m->args[0] = (int)r_u8(&r);
+            break;
+        case MSG_VIEW:
+            m->args[0] = (int)r_u16(&r);
+            m->args[1] = (int)r_u16(&r);
+            break;
+        case MSG_ROOM_LIST:
+            break;
+        default:
+            return -1;
+    }
+
+    return r.err ? -1 : 0;
+}
+
+// ---------- TEXTOVÉ PRÍKAZY ----------
+
+// každý textový príkaz končí '\n'
+int proto_format_cmd_text(const Message *m, char *out, int cap) {
+    switch (m->type) {
+        case MSG_NEW_GAME:
+            return snprintf(out, (size_t)cap, "NEW_GAME|%d|%d|%d|%d|%d|%d|%d\n",
+                            m->args[0], m->args[1], m->args[2], m->args[3], m->args[4], m->args[5], m->args[6]);
+        case MSG_PLAYER_NAME: return snprintf(out, (size_t)cap, "PLAYER|%s\n", m->data);
+        case MSG_MOVE:
+            return snprintf(out, (size_t)cap, "MOVE|%d|%d|%u\n", m->player_id, (int)m->direction, m->input_seq);
+        case MSG_QUIT:        return snprintf(out, (size_t)cap, "QUIT|%d\n", m->player_id);
+        case MSG_JOIN_GAME:   return snprintf(out, (size_t)cap, "ROOM_JOIN|%d\n", m->game_id);
+        case MSG_ROOM_LIST:   return snprintf(out, (size_t)cap, "ROOM_LIST\n");
+        case MSG_HELLO:       return snprintf(out, (size_t)cap, "HELLO|%d\n", m->args[0]);
+        default:              return -1;
+    }
+}
+
+int proto_text_frame(const char *buf, int len) {
+    const char *nl = (const char*)memchr(buf, '\n', (size_t)len);
+    return nl ? (int)(nl - buf) + 1 : 0;
+}
+
+#define MAX_TEXT_FIELDS 8
+
+// pole príkazu, ukazuje priamo do vstupného buffra
+typedef struct {
+    const char *p;
+    int len;
+} field_t;
+
+static int split_fields(const char *line, int len, field_t *f) {
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) len--;
+
+    int n = 0, start = 0;
+    for (int i = 0; i <= len && n < MAX_TEXT_FIELDS; i++) {
+        if (i == len || line[i] == '|') {
+            f[n].p = line + start;
+            f[n].len = i - start;
+            n++;
+            start = i + 1;
+        }
+    }
+    return n;
+}
+
+static int field_is(const field_t *f, const char *name) {
+    int n = (int)strlen(name);
+    return f->len == n && memcmp(f->p, name, (size_t)n) == 0;
+}
+
+static int field_int(const field_t *f, int *out) {
+    int i = 0, neg = 0;
+    long v = 0;
+    if (f->len > 0 && f->p[0] == '-') { neg = 1; i = 1; }
+    if (i >= f->len || f->len - i > 9) return -1;
+    for (; i < f->len; i++) {
+        if (f->p[i] < '0' || f->p[i] > '9') return -1;
+        v = v * 10 + (f->p[i] - '0');
+    }
+    *out = (int)(neg ? -v : v);
+    return 0;
+}
+
+static int arg_int(const field_t *f, int n, int i, int *out) {
+    return (i < n) ? field_int(&f[i], out) : -1;
+}
+
+// nepovinné pole, chýbajúce alebo prázdne dá def
+static int opt_int(const field_t *f, int n, int i, int *out, int def) {
+    if (i >= n || f[i].len == 0) {
+        *out = def;
+        return 0;
+    }
+    return field_int(&f[i], out);
+}
+
+int proto_parse_cmd_text(const char *line, int len, Message *m) {
+    field_t f[MAX_TEXT_FIELDS];
+    int n = split_fields(line, len, f);
+    memset(m, 0, sizeof(*m));
+    if (n == 0) return -1;
+
+    if (field_is(&f[0], "MOVE")) {
+        int dir, seq;
+        m->type = MSG_MOVE;
+        if (arg_int(f, n, 1, &m->player_id) < 0 || arg_int(f, n, 2, &dir) < 0) return -1;
+        if (opt_int(f, n, 3, &seq, 0) < 0) return -1;
+        m->direction = (Direction)dir;
+        m->input_seq = (unsigned int)seq;
+        return 0;
+    }
+    if (field_is(&f[0], "NEW_GAME") || field_is(&f[0], "ROOM_NEW")) {
+        m->type = MSG_NEW_GAME;
+        for (int i = 0; i < 5; i++) {
+            if (arg_int(f, n, 1 + i, &m->args[i]) < 0) return -1;
+        }
+        // tick_rate a tick_mode sú nepovinné, 0 = predvolený servera a tick po poradí
+        if (opt_int(f, n, 6, &m->args[5], 0) < 0) return -1;
+        return opt_int(f, n, 7, &m->args[6], 0);
+    }
+    if (field_is(&f[0], "ROOM_LIST")) {
+        m->type = MSG_ROOM_LIST;
+        return 0;
+    }
+    if (field_is(&f[0], "ROOM_JOIN")) {
+        m->type = MSG_JOIN_GAME;
+        return arg_int(f, n, 1, &m->game_id);
+    }
+    if (field_is(&f[0], "PLAYER")) {
+        m->type = MSG_PLAYER_NAME;
+        if (n > 1) {
+            int l = f[1].len < 49 ? f[1].len : 49;
+            memcpy(m->data, f[1].p, (size_t)l);
+            m->data[l] = '\0';
+        }
+        return 0;
+    }
+    if (field_is(&f[0], "QUIT")) {
+        m->type = MSG_QUIT;
+        (void)opt_int(f, n, 1, &m->player_id, 0);
+        return 0;
+    }
+    if (field_is(&f[0], "HELLO")) {
+        m->type = MSG_HELLO;
+        return arg_int(f, n, 1, &m->args[0]);
+    }
+    return -1;
+}
+
+// ---------- STAV HRY ----------
+
+// mapa ide ako RLE: bajt = (kód bunky << 5) | (dĺžka behu - 1)
+static const char cell_glyphs[] = { CELL_EMPTY, CELL_OBSTACLE, CELL_FRUIT, CELL_BODY, CELL_HEAD };
+#define NUM_CELL_CODES ((int)sizeof(cell_glyphs))
+#define RLE_MAX_RUN 32
+
+static int cell_code(char c) {
+    for (int i = 0; i < NUM_CELL_CODES; i++) {
+        if (cell_glyphs[i] == c) return i;
+    }
+    return 0;
+}
+
+// obdĺžnik vw x vh buniek, ktorých riadky sú stride od seba, ide ako jeden súvislý prúd behov
+static void w_map_rle(wbuf_t *w, const char *cells, int stride, int vw, int vh) {
+    int len_pos = w->len;
+    w_u32(w, 0);
+
+    char cur = 0;
+    int run = 0;
+    for (int y = 0; y < vh; y++) {
+        const char *row = cells + (size_t)y * (size_t)stride;
+        for (int x = 0; x < vw; x++) {
+            if (run > 0 && (row[x] != cur || run == RLE_MAX_RUN)) {
+                w_u8(w, (uint32_t)((cell_code(cur) << 5) | (run - 1)));
+                run = 0;
+            }
+            cur = row[x];
+            run++;
+        }
+    }
+    if (run > 0) w_u8(w, (uint32_t)((cell_code(cur) << 5) | (run - 1)));
+
+    if (w->err) return;
+    uint32_t bytes = (uint32_t)(w->len - len_pos - 4);
+    w->buf[len_pos]     = (uint8_t)(bytes >> 24);
+    w->buf[len_pos + 1] = (uint8_t)(bytes >> 16);
+    w->buf[len_pos + 2] = (uint8_t)(bytes >> 8);
+    w->buf[len_pos + 3] = (uint8_t)bytes;
+}
+
+static void r_map_rle(rbuf_t *r, char *cells, int stride, int vw, int vh) {
+    int bytes = (int)r_u32(r);
+    int n = vw * vh, k = 0;
+    int x = 0, y = 0;   // bunka k v obdĺžniku
+
+    for (int i = 0; i < bytes && !r->err; i++) {
+        uint32_t b = r_u8(r);
+        int code = (int)(b >> 5);
+        int run = (int)(b & 31) + 1;
+        char c = (code < NUM_CELL_CODES) ? cell_glyphs[code] : CELL_EMPTY;
+        for (int j = 0; j < run && k < n; j++, k++) {
+            cells[y * stride + x] = c;
+            if (++x == vw) { x = 0; y++; }
+        }
+    }
+
+    for (; k < n; k++) {
+        cells[y * stride + x] = CELL_EMPTY;
+        if (++x == vw) { x = 0; y++; }
+    }
+}
+
+// hlavička kľúčového stavu aj výrezu
+static void w_state_header(wbuf_t *w, const GameState *g, uint32_t seq) {
+    w_u32(w, (uint32_t)g->id);
+    w_u32(w, seq);
+    w_u16(w, (uint32_t)g->width);
+    w_u16(w, (uint32_t)g->height);
+    w_u16(w, (uint32_t)g->fruit_x);
+    w_u16(w, (uint32_t)g->fruit_y);
+    w_u8(w, (uint32_t)(g->active | (g->game_over << 1)));
+    w_u8(w, (uint32_t)g->mode);
+    w_u8(w, (uint32_t)g->world_type);
+    w_u32(w, (uint32_t)g->elapsed_time);
+    w_u32(w, g->tick);
+    w_u8(w, (uint32_t)g->tick_rate);
+}
+
+// -1 = rozmery mimo povolených
+static int r_state_header(rbuf_t *r, GameState *g, uint32_t *seq) {
+    g->id = (int)r_u32(r);
+    *seq = r_u32(r);
+    g->width = (int)r_u16(r);
+    g->height = (int)r_u16(r);
+    g->fruit_x = (int16_t)r_u16(r);
+    g->fruit_y = (int16_t)r_u16(r);
+    uint32_t flags = r_u8(r);
+    g->active = (int)(flags & 1);
+    g->game_over = (int)((flags >> 1) & 1);
+    g->mode = (GameMode)r_u8(r);
+    g->world_type = (WorldType)r_u8(r);
+    g->elapsed_time = (int)r_u32(r);
+    g->tick = r_u32(r);
+    g->tick_rate = (int)r_u8(r);
+    return (r->err || g->width > MAX_MAP_SIZE || g->height > MAX_MAP_SIZE) ? -1 : 0;
+}
+
+static void w_player(wbuf_t *w, const GameState *g, int i) {
+    const Player *p = &g->players[i];
+    w_u16(w, (uint32_t)p->id);
+    w_str(w, p->name);
+    w_u8(w, (uint32_t)player_alive(g, i));
+    w_u32(w, (uint32_t)p->score);
+    w_u16(w, g->head_x[i]);
+    w_u16(w, g->head_y[i]);
+    w_u32(w, g->body_len[i]);
+    w_u8(w, (uint32_t)player_dir(g, i));
+    w_u32(w, g->input_seq[i]);
+}
+
+static void r_player(rbuf_t *r, GameState *g, int i) {
+    Player *p = &g->players[i];
+    p->id = (int)r_u16(r);
+    r_str(r, p->name, (int)sizeof(p->name));
+    int alive = (int)r_u8(r);
+    p->score = (int)r_u32(r);
+    g->head_x[i] = (uint16_t)r_u16(r);
+    g->head_y[i] = (uint16_t)r_u16(r);
+    g->body_len[i] = r_u32(r);
+    Direction dir = (Direction)(r_u8(r) & PF_DIR_MASK);
+    g->input_seq[i] = r_u32(r);
+    g->pflags[i] = 0;
+    player_set_alive(g, i, alive);
+    player_set_dir(g, i, dir);
+}
+
+int proto_encode_state(const GameState *g, uint32_t seq, wbuf_t *w) {
+    int start = proto_frame_begin(w, MSG_GAME_STATE);
+
+    w_state_header(w, g, seq);
+    w_map_rle(w, g->grid, g->width, g->width, g->height);
+
+    w_u32(w, (uint32_t)g->num_obstacles);
+    for (int i = 0; i < g->num_obstacles; i++) {
+        w_u16(w, (uint32_t)g->obstacles[i][0]);
+        w_u16(w, (uint32_t)g->obstacles[i][1]);
+    }
+
+    w_u16(w, (uint32_t)g->num_players);
+    for (int i = 0; i < g->num_players; i++) w_player(w, g, i);
+
+    proto_frame_end(w, start);
+    return w->err ? -1 : 0;
+}
+
+// meno v rámci: u8 dĺžka + najviac sizeof(name) - 1 bajtov
+#define NAME_BYTES ((int)sizeof(((Player*)0)->name))
+
+#define STATE_PLAYER_BYTES (NAME_BYTES + 20)
+
+int proto_state_size(const GameState *g) {
+    int header = PROTO_HEADER_SIZE + 28;
+    int map = 4 + g->width * g->height;     // RLE nikdy nepresiahne bajt na bunku
+    int obstacles = 4 + 4 * g->num_obstacles;
+    int players = 2 + g->num_players * STATE_PLAYER_BYTES;
+    return header + map + obstacles + players;
+}
+
+int proto_max_players(int width, int height) {
+    int obstacles = width * height / OBSTACLE_CELLS;
+    if (obstacles < MIN_OBSTACLES) obstacles = MIN_OBSTACLES;
+    int fixed = PROTO_HEADER_SIZE + 28 + 4 + width * height + 4 + 4 * obstacles + 2;
+    int n = (PROTO_MAX_FRAME - fixed) / STATE_PLAYER_BYTES;
+    return (n > MAX_PLAYERS) ? MAX_PLAYERS : n;
+}
+
+// pole z old na n prvkov, nové prvky sú vynulované
+static int reserve_array(void **arr, int old, int n, size_t elem) {
+    char *p = (char*)realloc(*arr, (size_t)n * elem);
+    if (!p) return -1;
+    memset(p + (size_t)old * elem, 0, (size_t)(n - old) * elem);
+    *arr = p;
+    return 0;
+}
+
+int proto_state_reserve(GameState *g, int cells, int players, int obstacles) {
+    if (cells > g->cells_cap) {
+        char *grid = (char*)realloc(g->grid, (size_t)cells);
+        if (!grid) return -1;
+        g->grid = grid;
+        g->cells_cap = cells;
+    }
+    // klient má len polia, ktoré idú v rámci (bez tiel a next_seq)
+    if (players > g->players_cap) {
+        int old = g->players_cap;
+        if (reserve_array((void**)&g->head_x, old, players, sizeof(g->head_x[0])) < 0 ||
+            reserve_array((void**)&g->head_y, old, players, sizeof(g->head_y[0])) < 0 ||
+            reserve_array((void**)&g->pflags, old, players, sizeof(g->pflags[0])) < 0 ||
+            reserve_array((void**)&g->body_len, old, players, sizeof(g->body_len[0])) < 0 ||
+            reserve_array((void**)&g->input_seq, old, players, sizeof(g->input_seq[0])) < 0 ||
+            reserve_array((void**)&g->players, old, players, sizeof(g->players[0])) < 0) {
+            return -1;
+        }
+        g->players_cap = players;
+    }
+    if (obstacles > g->obstacles_cap) {
+        int (*obs)[2] = realloc(g->obstacles, (size_t)obstacles * sizeof(g->obstacles[0]));
+        if (!obs) return -1;
+        g->obstacles = obs;
+        g->obstacles_cap = obstacles;
+    }
+    return 0;
+}
+
+int proto_decode_state(const uint8_t *payload, int len, GameState *g, uint32_t *seq) {
+    rbuf_t r;
+    rbuf_init(&r, payload, len);
+
+    // rozmery a počty sa overia voči zvyšku rámca skôr, než sa podľa nich alokuje
+    g->num_obstacles = 0;
+    g->num_players = 0;
+    if (r_state_header(&r, g, seq) < 0) return -1;
+    int area = g->width * g->height;
+    if (proto_state_reserve(g, area, 0, 0) < 0) return -1;
+    r_map_rle(&r, g->grid, g->width, g->width, g->height);
+
+    int obs = (int)r_u32(&r);
+    if (r.err || obs > area || obs > (r.len - r.pos) / 4) return -1;
+    if (proto_state_reserve(g, 0, 0, obs) < 0) return -1;
+    for (int i = 0; i < obs; i++) {
+        g->obstacles[i][0] = (int)r_u16(&r);
+        g->obstacles[i][1] = (int)r_u16(&r);
+    }
+    g->num_obstacles = obs;
+
+    // hráč s prázdnym menom má 21 bajtov
+    int np = (int)r_u16(&r);
+    if (r.err || np > (r.len - r.pos) / 21 || proto_state_reserve(g, 0, np, 0) < 0) return -1;
+    for (int i = 0; i < np && !r.err; i++) r_player(&r, g, i);
+    if (r.err) return -1;
+    g->num_players = np;
+    return 0;
+}
+
+// ---------- VÝREZ ----------
+
+static int in_view(const ViewRect *v, int x, int y) {
+    return x >= v->x && x < v->x + v->w && y >= v->y && y < v->y + v->h;
+}
+
+int proto_encode_view(const GameState *g, const ViewRect *v, uint32_t seq, wbuf_t *w) {
+    int start = proto_frame_begin(w, MSG_VIEW_STATE);
+
+    w_state_header(w, g, seq);
+    w_u16(w, (uint32_t)v->x);
+    w_u16(w, (uint32_t)v->y);
+    w_u16(w, (uint32_t)v->w);
+    w_u16(w, (uint32_t)v->h);
+    w_map_rle(w, g->grid + v->y * g->width + v->x, g->width, v->w, v->h);
+
+    // hlavy sa prechádzajú lineárne, mená a skóre sa čítajú len pre hráčov vo výreze
+    int count = 0;
+    for (int i = 0; i < g->num_players; i++) count += in_view(v, g->head_x[i], g->head_y[i]);
+
+    w_u16(w, (uint32_t)g->num_players);
+    w_u16(w, (uint32_t)count);
+    for (int i = 0; i < g->num_players; i++) {
+        if (!in_view(v, g->head_x[i], g->head_y[i])) continue;
+        w_u16(w, (uint32_t)i);
+        w_player(w, g, i);
+    }
+
+    proto_frame_end(w, start);
+    return w->err ? -1 : 0;
+}
+
+int proto_view_size(const GameState *g, const ViewRect *v) {
+    int count = 0;
+    for (int i = 0; i < g->num_players; i++) count += in_view(v, g->head_x[i], g->head_y[i]);
+
+    int header = PROTO_HEADER_SIZE + 28 + 8;
+    int map = 4 + v->w * v->h;
+    int players = 4 + count * (2 + NAME_BYTES + 20);
+    return header + map + players;
+}
+
+int proto_decode_view(const uint8_t *payload, int len, GameState *g, uint32_t *seq, ViewRect *v) {
+    rbuf_t r;
+    rbuf_init(&r, payload, len);
+
+    if (r_state_header(&r, g, seq) < 0) return -1;
+    v->x = (int)r_u16(&r);
+    v->y = (int)r_u16(&r);
+    v->w = (int)r_u16(&r);
+    v->h = (int)r_u16(&r);
+    if (r.err || v->x + v->w > g->width || v->y + v->h > g->height) return -1;
+    if (proto_state_reserve(g, g->width * g->height, 0, 0) < 0) return -1;
+    r_map_rle(&r, g->grid + v->y * g->width + v->x, g->width, v->w, v->h);
+
+    // prekážky sú vo výreze ako bunky, zoznam sa neposiela
+    g->num_obstacles = 0;
+
+    int np = (int)r_u16(&r);
+    int count = (int)r_u16(&r);
+    if (r.err || count > np || count > (r.len - r.pos) / 23 || proto_state_reserve(g, 0, np, 0) < 0) return -1;
+    for (int k = 0; k < count && !r.err; k++) {
+        int i = (int)r_u16(&r);
+        if (i >= np) return -1;
+        r_player(&r, g, i);
+    }
+    if (r.err) return -1;
+    g->num_players = np;
+    return 0;
+}
+
+// ---------- DELTA ----------
+
+enum {
+    PD_ALIVE = 1,
+    PD_SCORE = 2,
+    PD_HEAD  = 4,
+    PD_LEN   = 8,
+    PD_DIR   = 16,
+    PD_NAME  = 32,  // nový hráč: id + meno
+    PD_INPUT = 64
+};
+
+static int player_delta_mask(const GameState *g, const StateBaseline *base, int i) {
+    if (i >= base->num_players) return PD_ALIVE | PD_SCORE | PD_HEAD | PD_LEN | PD_DIR | PD_NAME | PD_INPUT;
+
+    const PlayerView *v = &base->players[i];
+    const Player *p = &g->players[i];
+    int mask = 0;
+    if (v->alive != player_alive(g, i)) mask |= PD_ALIVE;
+    if (v->score != p->score) mask |= PD_SCORE;
+    if (v->head_x != g->head_x[i] || v->head_y != g->head_y[i]) mask |= PD_HEAD;
+    if (v->body_len != g->body_len[i]) mask |= PD_LEN;
+    if (v->direction != player_dir(g, i)) mask |= PD_DIR;
+    if (v->input_seq != g->input_seq[i]) mask |= PD_INPUT;
+    if (v->id != p->id || strcmp(v->name, p->name) != 0) mask |= PD_NAME;
+    return mask;
+}
+
+// hlavička (ovocie, príznaky, čas) je malá, ide vždy celá
+static void w_delta_header(wbuf_t *w, const GameState *g) {
+    w_u16(w, (uint32_t)g->fruit_x);
+    w_u16(w, (uint32_t)g->fruit_y);
+    w_u8(w, (uint32_t)(g->active | (g->game_over << 1)));
+    w_u32(w, (uint32_t)g->elapsed_time);
+    w_u32(w, g->tick);
+}
+
+int proto_encode_delta(const GameState *g, const StateBaseline *base, uint32_t seq, wbuf_t *w) {
+    int start = proto_frame_begin(w, MSG_STATE_DELTA);
+
+    w_u32(w, (uint32_t)g->id);
+    w_u32(w, seq);
+    w_delta_header(w, g);
+
+    w_u32(w, (uint32_t)g->num_dirty);
+    for (int i = 0; i < g->num_dirty; i++) {
+        int cell = g->dirty_cells[i];
+        w_u32(w, (uint32_t)cell);
+        w_u8(w, (uint32_t)cell_code(g->grid[cell]));
+    }
+
+    int changed = 0;
+    for (int i = 0; i < g->num_players; i++) {
+        if (player_delta_mask(g, base, i)) changed++;
+    }
+
+    w_u16(w, (uint32_t)g->num_players);
+    w_u16(w, (uint32_t)changed);
+    for (int i = 0; i < g->num_players; i++) {
+        int mask = player_delta_mask(g, base, i);
+        if (!mask) continue;
+
+        const Player *p = &g->players[i];
+        w_u16(w, (uint32_t)i);
+        w_u8(w, (uint32_t)mask);
+        if (mask & PD_NAME) { w_u16(w, (uint32_t)p->id); w_str(w, p->name); }
+        if (mask & PD_ALIVE) w_u8(w, (uint32_t)player_alive(g, i));
+        if (mask & PD_SCORE) w_u32(w, (uint32_t)p->score);
+        if (mask & PD_HEAD)  { w_u16(w, g->head_x[i]); w_u16(w, g->head_y[i]); }
+        if (mask & PD_LEN)   w_u32(w, g->body_len[i]);
+        if (mask & PD_DIR)   w_u8(w, (uint32_t)player_dir(g, i));
+        if (mask & PD_INPUT) w_u32(w, g->input_seq[i]);
+    }
+
+    proto_frame_end(w, start);
+    return w->err ? -1 : 0;
+}
+
+int proto_delta_size(const GameState *g) {
+    int header = PROTO_HEADER_SIZE + 8 + 13;
+    int cells = 4 + 5 * g->num_dirty;
+    int players = 4 + g->num_players * (NAME_BYTES + 23);
+    return header + cells + players;
+}
+
+void proto_baseline_update(StateBaseline *base, const GameState *g, uint32_t seq) {
+    base->seq = seq;
+    if (g->num_players > base->players_cap) {
+        PlayerView *v = (PlayerView*)realloc(base->players, (size_t)g->num_players * sizeof(PlayerView));
+        if (!v) {
+            base->num_players = 0;
+            return;
+        }
+        base->players = v;
+        base->players_cap = g->num_players;
+    }
+    base->num_players = g->num_players;
+    for (int i = 0; i < g->num_players; i++) {
+        const Player *p = &g->players[i];
+        PlayerView *v = &base->players[i];
+        v->id = p->id;
+        v->alive = player_alive(g, i);
+        v->score = p->score;
+        v->head_x = g->head_x[i];
+        v->head_y = g->head_y[i];
+        v->body_len = g->body_len[i];
+        v->direction = player_dir(g, i);
+        v->input_seq = g->input_seq[i];
+        memcpy(v->name, p->name, sizeof(v->name));
+    }
+}
+
+void proto_baseline_free(StateBaseline *base) {
+    free(base->players);
+    memset(base, 0, sizeof(*base));
+}
+
+int proto_apply_delta(const uint8_t *payload, int len, GameState *g, uint32_t *seq,
+                      proto_cell_cb on_cell, void *ctx) {
+    rbuf_t r;
+    rbuf_init(&r, payload, len);
+
+    int id = (int)r_u32(&r);
+    uint32_t s = r_u32(&r);
+    if (r.err) return -1;
+    if (id != g->id || s != *seq + 1) return 1;
+
+    g->fruit_x = (int16_t)r_u16(&r);
+    g->fruit_y = (int16_t)r_u16(&r);
+    uint32_t flags = r_u8(&r);
+    g->active = (int)(flags & 1);
+    g->game_over = (int)((flags >> 1) & 1);
+    g->elapsed_time = (int)r_u32(&r);
+    g->tick = r_u32(&r);
+
+    int ncells = (int)r_u32(&r);
+    int area = g->width * g->height;
+    for (int i = 0; i < ncells && !r.err; i++) {
+        int cell = (int)r_u32(&r);
+        int code = (int)r_u8(&r);
+        if (cell < 0 || cell >= area || code >= NUM_CELL_CODES) return -1;
+        g->grid[cell] = cell_glyphs[code];
+        if (on_cell) on_cell(ctx, cell, cell_glyphs[code]);
+    }
+
+    int np = (int)r_u16(&r);
+    int changed = (int)r_u16(&r);
+    if (r.err || changed > np || proto_state_reserve(g, 0, np, 0) < 0) return -1;
+    for (int k = 0; k < changed && !r.err; k++) {
+        int i = (int)r_u16(&r);
+        int mask = (int)r_u8(&r);
+        if (i >= np) return -1;
+
+        Player *p = &g->players[i];
+        if (mask & PD_NAME) { p->id = (int)r_u16(&r); r_str(&r, p->name, (int)sizeof(p->name)); }
+        if (mask & PD_ALIVE) player_set_alive(g, i, (int)r_u8(&r));
+        if (mask & PD_SCORE) p->score = (int)r_u32(&r);
+        if (mask & PD_HEAD)  { g->head_x[i] = (uint16_t)r_u16(&r); g->head_y[i] = (uint16_t)r_u16(&r); }
+        if (mask & PD_LEN)   g->body_len[i] = r_u32(&r);
+        if (mask & PD_DIR)   player_set_dir(g, i, (Direction)(r_u8(&r) & PF_DIR_MASK));
+        if (mask & PD_INPUT) g->input_seq[i] = r_u32(&r);
+    }
+    g->num_players = np;
+
+    if (r.err) return -1;
+    *seq = s;
+    return 0;
+}
+
+// ---------- MIESTNOSTI ----------
+
+int proto_encode_rooms(const RoomInfo *rooms, int count, int total, wbuf_t *w) {
+    int start = proto_frame_begin(w, MSG_ROOMS);
+    w_u32(w, (uint32_t)total);
+    w_u16(w, (uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        w_u32(w, (uint32_t)rooms[i].id);
+        w_u16(w, (uint32_t)rooms[i].players);
+        w_u16(w, (uint32_t)rooms[i].max_players);
+        w_u16(w, (uint32_t)rooms[i].width);
+        w_u16(w, (uint32_t)rooms[i].height);
+        w_u8(w, (uint32_t)rooms[i].mode);
+        w_u8(w, (uint32_t)rooms[i].world_type);
+    }
+    proto_frame_end(w, start);
+    return w->err ? -1 : 0;
+}
+
+int proto_decode_rooms(const uint8_t *payload, int len, RoomInfo *rooms, int cap, int *count, int *total) {
+    rbuf_t r;
+    rbuf_init(&r, payload, len);
+    *total = (int)r_u32(&r);
+    int n = (int)r_u16(&r);
+    *count = 0;
+    for (int i = 0; i < n && !r.err; i++) {
+        RoomInfo ri;
+        ri.id = (int)r_u32(&r);
+        ri.players = (int)r_u16(&r);
+        ri.max_players = (int)r_u16(&r);
+        ri.width = (int)r_u16(&r);
+        ri.height = (int)r_u16(&r);
+        ri.mode = (int)r_u8(&r);
+        ri.world_type = (int)r_u8(&r);
+        if (*count < cap) rooms[(*count)++] = ri;
+    }
+    return r.err ? -1 : 0;
+}
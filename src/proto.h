@@ -0,0 +1,132 @@
+#ifndef PROTO_H
+#define PROTO_H
+
+#include <stdint.h>
+#include "snake.h"
+
+// binárny protokol: rámec = u32 dĺžka (typ + payload, big-endian), u8 MessageType, payload
+#define PROTO_VERSION 5
+#define PROTO_HEADER_SIZE 5
+#define PROTO_MAX_FRAME (1 << 20)
+
+typedef struct {
+    uint8_t *buf;
+    int cap;
+    int len;
+    int err;    // nezmestilo sa
+} wbuf_t;
+
+typedef struct {
+    const uint8_t *buf;
+    int len;
+    int pos;
+    int err;    // čítanie za koncom
+} rbuf_t;
+
+// hráč tak, ako ho klienti videli v poslednom odoslanom stave
+typedef struct {
+    int id;
+    int score;
+    uint16_t head_x;
+    uint16_t head_y;
+    uint32_t body_len;
+    uint32_t input_seq;
+    uint8_t alive;
+    uint8_t direction;
+    char name[50];
+} PlayerView;
+
+// posledný odoslaný stav miestnosti, voči nemu sa počíta delta
+typedef struct {
+    uint32_t seq;
+    int num_players;
+    int players_cap;
+    PlayerView *players;
+} StateBaseline;
+
+// obdĺžnik mapy, ktorý klient dostáva (x, y = ľavý horný roh)
+typedef struct {
+    int x;
+    int y;
+    int w;
+    int h;
+} ViewRect;
+
+typedef struct {
+    int id;
+    int players;
+    int max_players;
+    int width;
+    int height;
+    int mode;
+    int world_type;
+} RoomInfo;
+
+void wbuf_init(wbuf_t *w, void *buf, int cap);
+void w_u8(wbuf_t *w, uint32_t v);
+void w_u16(wbuf_t *w, uint32_t v);
+void w_u32(wbuf_t *w, uint32_t v);
+void w_str(wbuf_t *w, const char *s);
+void w_bytes(wbuf_t *w, const void *p, int n);
+
+void rbuf_init(rbuf_t *r, const void *buf, int len);
+uint32_t r_u8(rbuf_t *r);
+uint32_t r_u16(rbuf_t *r);
+uint32_t r_u32(rbuf_t *r);
+void r_str(rbuf_t *r, char *out, int cap);
+
+// začne rámec daného typu, proto_frame_end doplní dĺžku
+int proto_frame_begin(wbuf_t *w, MessageType type);
+void proto_frame_end(wbuf_t *w, int start);
+
+// hlavička rámca v buffri: 1 = celý rámec je k dispozícii, 0 = treba viac dát, -1 = chyba
+int proto_frame_peek(const uint8_t *buf, int len, MessageType *type, int *payload_len);
+
+// jednoduché odpovede servera (ASSIGN, ROOM, ROOM_ERR, SERVER_FULL, HELLO) nesú jedno u32
+int proto_encode_u32(MessageType type, uint32_t value, wbuf_t *w);
+
+// príkazy klient -> server (oba smery kódovania)
+int proto_encode_cmd(const Message *m, wbuf_t *w);
+int proto_decode_cmd(MessageType type, const uint8_t *payload, int len, Message *m);
+int proto_format_cmd_text(const Message *m, char *out, int cap);
+
+// textové príkazy sú riadky ukončené '\n'; vráti dĺžku prvého celého riadku (aj s '\n'), 0 = ešte nie je celý
+int proto_text_frame(const char *buf, int len);
+// rozloží riadok na polia priamo v buffri (bez kopírovania a bez '\0' na konci)
+int proto_parse_cmd_text(const char *line, int len, Message *m);
+
+// kľúčový rámec = celý stav; mapa sa berie z g->grid a pri dekódovaní sa tam aj zapíše
+int proto_encode_state(const GameState *g, uint32_t seq, wbuf_t *w);
+int proto_decode_state(const uint8_t *payload, int len, GameState *g, uint32_t *seq);
+// horná hranica veľkosti rámca (aj s hlavičkou), buffer tejto veľkosti sa nikdy nepreplní
+int proto_state_size(const GameState *g);
+// najviac hráčov, pri ktorých sa kľúčový rámec mapy width x height (s prekážkami) zmestí do PROTO_MAX_FRAME
+int proto_max_players(int width, int height);
+
+// pamäť dekódovaného stavu (grid, hráči, prekážky) pre aspoň toľko prvkov, -1 = nedostatok pamäte
+int proto_state_reserve(GameState *g, int cells, int players, int obstacles);
+
+// delta rámec: bunky z g->dirty_cells a polia hráčov, ktoré sa líšia od base
+int proto_encode_delta(const GameState *g, const StateBaseline *base, uint32_t seq, wbuf_t *w);
+int proto_delta_size(const GameState *g);
+// bez pamäte na nových hráčov ostane základ prázdny a ďalšia delta pošle všetkých hráčov celých
+void proto_baseline_update(StateBaseline *base, const GameState *g, uint32_t seq);
+void proto_baseline_free(StateBaseline *base);
+
+// aplikuje deltu na g, ak nadväzuje na *seq; 0 = aplikovaná, 1 = medzera (čakaj na kľúčový), -1 = chyba
+// on_cell (môže byť NULL) dostane každú zmenenú bunku
+typedef void (*proto_cell_cb)(void *ctx, int cell, char c);
+int proto_apply_delta(const uint8_t *payload, int len, GameState *g, uint32_t *seq,
+                      proto_cell_cb on_cell, void *ctx);
+
+// stav vo výreze: hlavička ako pri kľúčovom, bunky výrezu a hráči s hlavou vo výreze (aj s indexom);
+// každý výrez je samostatný, delta naň nenadväzuje
+int proto_encode_view(const GameState *g, const ViewRect *v, uint32_t seq, wbuf_t *w);
+int proto_view_size(const GameState *g, const ViewRect *v);
+// zapíše bunky výrezu na ich miesto v g->grid (mriežka má rozmery celej mapy), hráčov mimo výrezu nemení
+int proto_decode_view(const uint8_t *payload, int len, GameState *g, uint32_t *seq, ViewRect *v);
+
+int proto_encode_rooms(const RoomInfo *rooms, int count, int total, wbuf_t *w);
+int proto_decode_rooms(const uint8_t *payload, int len, RoomInfo *rooms, int cap, int *count, int *total);
+
+#endif
@@ -0,0 +1,298 @@
+#define _POSIX_C_SOURCE 200809L
+#include "render.h"
+#include "snake.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+// keď terminál veľkosť nepovie (presmerovaný výstup), kreslí sa do takejto plochy
+#define DEFAULT_ROWS 60
+#define DEFAULT_COLS 100
+
+// presun kurzora stojí ~8 bajtov, kratšiu medzeru je lacnejšie prepísať
+#define MAX_SKIP_REWRITE 4
+
+static const scell_t blank = { { ' ' }, 1, ATTR_PLAIN };
+
+// SGR pre každý atribút; ATTR_PLAIN je zároveň reset na konci snímku
+#define SGR(s) { s, (int)sizeof(s) - 1 }
+static const struct { const char *seq; int len; } sgr[ATTR_COUNT] = {
+    [ATTR_PLAIN]    = SGR("\033[0m"),
+    [ATTR_BORDER]   = SGR("\033[0;36m"),
+    [ATTR_HEAD]     = SGR("\033[0;1;33m"),
+    [ATTR_BODY]     = SGR("\033[0;32m"),
+    [ATTR_FRUIT]    = SGR("\033[0;1;31m"),
+    [ATTR_OBSTACLE] = SGR("\033[0;90m"),
+};
+
+// bunky mapy podľa znaku v gride, čo tu nie je (len == 0), ide ako obyčajný znak
+static const scell_t map_glyphs[256] = {
+    [' ']           = { { ' ' }, 1, ATTR_PLAIN },
+    [CELL_EMPTY]    = { { ' ' }, 1, ATTR_PLAIN },
+    [CELL_OBSTACLE] = { { '#' }, 1, ATTR_OBSTACLE },
+    [CELL_FRUIT]    = { { '*' }, 1, ATTR_FRUIT },
+    [CELL_BODY]     = { { '~' }, 1, ATTR_BODY },
+    [CELL_HEAD]     = { { '@' }, 1, ATTR_HEAD },
+};
+
+static const scell_t border_h  = { "═", 3, ATTR_BORDER };
+static const scell_t border_v  = { "║", 3, ATTR_BORDER };
+static const scell_t border_tl = { "╔", 3, ATTR_BORDER };
+static const scell_t border_tr = { "╗", 3, ATTR_BORDER };
+static const scell_t border_bl = { "╚", 3, ATTR_BORDER };
+static const scell_t border_br = { "╝", 3, ATTR_BORDER };
+
+int screen_init(screen_t *s, int rows, int cols) {
+    memset(s, 0, sizeof(*s));
+    if (rows < 1) rows = 1;
+    if (cols < 1) cols = 1;
+
+    size_t n = (size_t)rows * (size_t)cols;
+    s->front = (scell_t*)malloc(n * sizeof(scell_t));
+    s->back = (scell_t*)malloc(n * sizeof(scell_t));
+    // najhorší prípad: každá bunka so 4-bajtovým znakom, vlastným presunom kurzora a farbou
+    s->out_cap = (int)(n * (4 + 16 + 12)) + 64;
+    s->out = (char*)malloc((size_t)s->out_cap);
+    if (!s->front || !s->back || !s->out) {
+        screen_free(s);
+        return -1;
+    }
+
+    s->rows = rows;
+    s->cols = cols;
+    for (size_t i = 0; i < n; i++) s->front[i] = s->back[i] = blank;
+    s->full_redraw = 1;
+    s->colors = 1;
+    return 0;
+}
+
+void screen_free(screen_t *s) {
+    free(s->front);
+    free(s->back);
+    free(s->out);
+    s->front = s->back = NULL;
+    s->out = NULL;
+    s->rows = s->cols = 0;
+}
+
+int screen_fit_terminal(screen_t *s, int fd) {
+    int rows = DEFAULT_ROWS, cols = DEFAULT_COLS;
+    struct winsize ws;
+    if (ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        rows = ws.ws_row;
+        cols = ws.ws_col;
+    }
+
+    if (s->front && rows == s->rows && cols == s->cols) return 0;
+
+    int colors = s->front ? s->colors : 1;
+    screen_free(s);
+    if (screen_init(s, rows, cols) < 0) return -1;
+    s->colors = colors;
+    return 1;
+}
+
+void screen_invalidate(screen_t *s) {
+    s->full_redraw = 1;
+}
+
+void screen_set_colors(screen_t *s, int on) {
+    if (s->colors == on) return;
+    s->colors = on;
+    s->full_redraw = 1;
+}
+
+void screen_begin(screen_t *s) {
+    size_t n = (size_t)s->rows * (size_t)s->cols;
+    for (size_t i = 0; i < n; i++) s->back[i] = blank;
+}
+
+static int utf8_len(unsigned char c) {
+    if (c < 0x80) return 1;
+    if ((c & 0xE0) == 0xC0) return 2;
+    if ((c & 0xF0) == 0xE0) return 3;
+    if ((c & 0xF8) == 0xF0) return 4;
+    return 1;   // pokračovací bajt bez začiatku, berie sa ako jeden znak
+}
+
+int screen_text(screen_t *s, int row, int col, const char *utf8) {
+    const unsigned char *p = (const unsigned char*)utf8;
+
+    while (*p) {
+        int len = utf8_len(*p);
+        for (int i = 1; i < len; i++) {
+            if (!p[i]) { len = i; break; }
+        }
+
+        if (row >= 0 && row < s->rows && col >= 0 && col < s->cols) {
+            scell_t *c = &s->back[row * s->cols + col];
+            memcpy(c->ch, p, (size_t)len);
+            c->len = (unsigned char)len;
+            c->attr = ATTR_PLAIN;
+        }
+        p += len;
+        col++;
+    }
+    return col;
+}
+
+int screen_printf(screen_t *s, int row, int col, const char *fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return screen_text(s, row, col, buf);
+}
+
+static inline void put(screen_t *s, int row, int col, const scell_t *c) {
+    if (col < s->cols) s->back[row * s->cols + col] = *c;
+}
+
+int screen_draw_map(screen_t *s, int row, const char *cells, int stride, int w, int h, int cell_w) {
+    int inner = w * cell_w;
+
+    if (row >= 0 && row < s->rows) {
+        put(s, row, 0, &border_tl);
+        for (int i = 0; i < inner; i++) put(s, row, 1 + i, &border_h);
+        put(s, row, 1 + inner, &border_tr);
+    }
+    row++;
+
+    for (int y = 0; y < h; y++, row++) {
+        if (row < 0 || row >= s->rows) continue;
+        const unsigned char *src = (const unsigned char*)cells + y * stride;
+        int col = 0;
+
+        put(s, row, col++, &border_v);
+        for (int x = 0; x < w; x++) {
+            scell_t g = map_glyphs[src[x]];
+            if (g.len == 0) {
+                g.ch[0] = (char)src[x];
+                g.len = 1;
+            }
+            for (int k = 0; k < cell_w; k++) put(s, row, col++, &g);
+        }
+        put(s, row, col, &border_v);
+    }
+
+    if (row >= 0 && row < s->rows) {
+        put(s, row, 0, &border_bl);
+        for (int i = 0; i < inner; i++) put(s, row, 1 + i, &border_h);
+        put(s, row, 1 + inner, &border_br);
+    }
+    return row + 1;
+}
+
+static int cell_eq(const scell_t *a, const scell_t *b) {
+    return a->len == b->len && a->attr == b->attr && memcmp(a->ch, b->ch, a->len) == 0;
+}
+
+// \033[r;cH bez printf
+static int put_cup(char *out, int r, int c) {
+    char tmp[24];
+    int n = 0, t = 0;
+    out[n++] = '\033';
+    out[n++] = '[';
+    do { tmp[t++] = (char)('0' + r % 10); r /= 10; } while (r);
+    while (t) out[n++] = tmp[--t];
+    out[n++] = ';';
+    do { tmp[t++] = (char)('0' + c % 10); c /= 10; } while (c);
+    while (t) out[n++] = tmp[--t];
+    out[n++] = 'H';
+    return n;
+}
+
+// znak bunky, pred ním SGR len keď sa farba líši od predchádzajúcej (behy sa zlejú)
+static inline int put_cell(const screen_t *s, char *out, const scell_t *c, int *cur_attr) {
+    int n = 0;
+    int a = s->colors ? c->attr : ATTR_PLAIN;
+    if (a != *cur_attr) {
+        memcpy(out, sgr[a].seq, (size_t)sgr[a].len);
+        n = sgr[a].len;
+        *cur_attr = a;
+    }
+    memcpy(out + n, c->ch, c->len);
+    return n + c->len;
+}
+
+// celý výstup jedným write(); stdout zdieľa O_NONBLOCK so stdin, takže pri EAGAIN sa čaká
+static int write_all(int fd, const char *buf, int len) {
+    int done = 0;
+    while (done < len) {
+        ssize_t n = write(fd, buf + done, (size_t)(len - done));
+        if (n > 0) {
+            done += (int)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            fd_set wfds;
+            FD_ZERO(&wfds);
+            FD_SET(fd, &wfds);
+            struct timeval tv = { 0, 100000 };
+            if (select(fd + 1, NULL, &wfds, NULL, &tv) > 0) continue;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int screen_flush(screen_t *s, int fd) {
+    static const char clear[] = "\033[0m\033[H\033[2J";
+    int n = 0;
+    int cur_r = -1, cur_c = -1;
+    int cur_attr = ATTR_PLAIN;  // každý snímok končí resetom
+    int full = s->full_redraw;
+
+    if (full) {
+        memcpy(s->out, clear, sizeof(clear) - 1);
+        n += (int)sizeof(clear) - 1;
+        cur_r = 0;
+        cur_c = 0;
+    }
+
+    for (int r = 0; r < s->rows; r++) {
+        const scell_t *back = &s->back[r * s->cols];
+        const scell_t *front = &s->front[r * s->cols];
+
+        for (int c = 0; c < s->cols; c++) {
+            // po vymazaní je na termináli všade medzera
+            const scell_t *was = full ? &blank : &front[c];
+            if (cell_eq(&back[c], was)) continue;
+
+            if (r == cur_r && c > cur_c && c - cur_c <= MAX_SKIP_REWRITE && !full) {
+                // medzera cez nezmenené bunky, prepíšu sa tým, čo tam už je
+                for (int k = cur_c; k < c; k++) n += put_cell(s, s->out + n, &back[k], &cur_attr);
+            } else if (r != cur_r || c != cur_c) {
+                n += put_cup(s->out + n, r + 1, c + 1);
+            }
+
+            n += put_cell(s, s->out + n, &back[c], &cur_attr);
+            cur_r = r;
+            cur_c = c + 1;
+        }
+    }
+
+    if (cur_attr != ATTR_PLAIN) {
+        memcpy(s->out + n, sgr[ATTR_PLAIN].seq, (size_t)sgr[ATTR_PLAIN].len);
+        n += sgr[ATTR_PLAIN].len;
+    }
+
+    memcpy(s->front, s->back, (size_t)s->rows * (size_t)s->cols * sizeof(scell_t));
+    s->full_redraw = 0;
+    if (n == 0) return 0;
+
+    // nedokončený zápis nechá terminál v neznámom stave
+    if (write_all(fd, s->out, n) < 0) {
+        s->full_redraw = 1;
+        return -1;
+    }
+    return n;
+}
@@ -0,0 +1,58 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+// obrazovka ako mriežka buniek: kreslí sa do zadného buffra, screen_flush pošle
+// terminálu len bunky, ktoré sa od minulého snímku zmenili, jedným write()
+
+// farba bunky, index do tabuľky SGR sekvencií v render.c
+enum {
+    ATTR_PLAIN,
+    ATTR_BORDER,
+    ATTR_HEAD,
+    ATTR_BODY,
+    ATTR_FRUIT,
+    ATTR_OBSTACLE,
+    ATTR_COUNT
+};
+
+typedef struct {
+    char ch[4];             // jeden znak v UTF-8
+    unsigned char len;
+    unsigned char attr;
+} scell_t;
+
+typedef struct {
+    int rows;
+    int cols;
+    scell_t *front;         // čo je práve na termináli
+    scell_t *back;          // čo sa kreslí
+    int full_redraw;        // terminál je v neznámom stave, prekreslí sa všetko
+    int colors;             // posielať ANSI farby
+    char *out;
+    int out_cap;
+} screen_t;
+
+int screen_init(screen_t *s, int rows, int cols);
+void screen_free(screen_t *s);
+
+// prispôsobí sa veľkosti terminálu na fd, 1 = zmenila sa (nasleduje celé prekreslenie)
+int screen_fit_terminal(screen_t *s, int fd);
+
+void screen_invalidate(screen_t *s);
+void screen_set_colors(screen_t *s, int on);
+
+// vyprázdni zadný buffer pred kreslením snímku
+void screen_begin(screen_t *s);
+
+// text od (row, col), čo sa nezmestí, sa oreže; vráti stĺpec za textom
+int screen_text(screen_t *s, int row, int col, const char *utf8);
+int screen_printf(screen_t *s, int row, int col, const char *fmt, ...);
+
+// herná mapa s rámikom; cells[y * stride + x] sú znaky CELL_* (alebo ' '),
+// každá bunka mapy má cell_w stĺpcov; vráti riadok pod rámikom
+int screen_draw_map(screen_t *s, int row, const char *cells, int stride, int w, int h, int cell_w);
+
+// pošle rozdiel oproti minulému snímku, vráti počet zapísaných bajtov alebo -1
+int screen_flush(screen_t *s, int fd);
+
+#endif
@@ -1,30 +1,65 @@
 #define _POSIX_C_SOURCE 200809L
 #include "snake.h"
+#include "proto.h"
+#include "game.h"
+#include "journal.h"
+#include "metrics.h"
 
 #include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
 
-#ifndef MAX_CLIENTS
-#define MAX_CLIENTS 10
-#endif
-
 #ifndef BUFFER_SIZE
 #define BUFFER_SIZE 8192
 #endif
 
-static void sleep_us(long usec) {
-    if (usec <= 0) return;
-    struct timespec ts;
-    ts.tv_sec = usec / 1000000L;
-    ts.tv_nsec = (usec % 1000000L) * 1000L;
-    nanosleep(&ts, NULL);
+// spojení môže byť viac ako hráčov (diváci), hráčov v miestnosti obmedzuje max_players (-p)
+#define MAX_CONNECTIONS 1024
+#define OUT_BUF_SIZE 65536      // max. bajtov čakajúcich na odoslanie (prázdny front vezme aj väčší rámec)
+#define OUT_QUEUE_LEN 256       // max. rámcov vo fronte spojenia
+#define OUT_IOV_MAX 16          // koľko rámcov ide jedným sendmsg
+#define SLOW_BACKLOG_FRAMES 4       // od koľkých čakajúcich rámcov je klient pomalý
+#define SLOW_BACKLOG_BYTES 16384    // alebo od koľkých bajtov neodoslaných v jadre
+
+// čo robiť s klientom, ktorý nestíha prijímať
+typedef enum {
+    SLOW_LATEST,    // zahodí staré stavy, pošle len najnovší
+    SLOW_THROTTLE,  // vynechá ticky, kým sa front nevyprázdni
+    SLOW_KICK       // odpojí ho
+} SlowPolicy;
+#define IN_BUF_SIZE 16384
+#define MAX_EVENTS 64
+
+// epoll tagy pre ne-klientske deskriptory (klienti majú tag = index v clients[])
+#define TAG_LISTEN 0xFFFFFFF0u
+#define TAG_WAKE   0xFFFFFFF1u
+
+#define NSEC_PER_SEC 1000000000LL
+
+static void ts_add_ns(struct timespec *t, long long ns) {
+    long long nsec = (long long)t->tv_nsec + ns;
+    t->tv_sec += (time_t)(nsec / NSEC_PER_SEC);
+    t->tv_nsec = (long)(nsec % NSEC_PER_SEC);
+}
+
+// a - b v nanosekundách
+static long long ts_diff_ns(const struct timespec *a, const struct timespec *b) {
+    return (long long)(a->tv_sec - b->tv_sec) * NSEC_PER_SEC + (a->tv_nsec - b->tv_nsec);
 }
 
 static int parse_port(int argc, char **argv) {
@@ -41,566 +76,1728 @@ static int parse_port(int argc, char **argv) {
     return port;
 }
 
+typedef struct room room_t;
+
+#define INBOX_LEN 16    // otočky jedného hráča čakajúce na ticky, ďalšie sa zahodia a spočítajú
+
+// schránka vstupov hráča: jeden zapisovateľ (reaktor, bez zámku), jeden čitateľ (tick pod mtx
+// miestnosti); head a tail len rastú, položka je na indexe % INBOX_LEN
+typedef struct {
+    uint32_t head;          // ďalšia nevybraná, píše tick
+    uint32_t tail;          // ďalšia voľná, píše reaktor
+    uint32_t seq[INBOX_LEN];
+    uint8_t dir[INBOX_LEN];
+    uint8_t quit;           // QUIT čaká na tick
+} inbox_t;
+
+// raz zakódovaný rámec zdieľaný viacerými spojeniami, uvoľní ho posledný odosielateľ
+typedef struct {
+    int refs;
+    int len;
+    int state;      // stav hry, pri zahltení sa smie zahodiť
+    char data[];
+} frame_t;
+
 typedef struct {
     int socket;
     int player_id;
     int in_use;
+    room_t *room;
+    int binary;         // po HELLO sa hovorí binárnym protokolom (proto.h)
+    int need_keyframe;  // čaká na celý stav (chráni mtx miestnosti)
+
+    // výrez mapy (chráni mtx miestnosti): vyžiadaná veľkosť (0 = predvolená servera) a kamera
+    int view_w;
+    int view_h;
+    ViewRect view;
+    int have_view;      // 0 = kamera sa pri ďalšom stave umiestni znova
+
+    // prijaté, ešte nespracované príkazy (riadky alebo binárne rámce)
+    char *in;
+    int in_len;
+
+    // odchádzajúce rámce, plní ich tick worker a posiela reaktor
+    pthread_mutex_t out_mtx;
+    frame_t **outq;     // kruhový front OUT_QUEUE_LEN odkazov
+    int out_head;
+    int out_count;
+    int out_off;        // koľko z prvého rámca už odišlo
+    int out_bytes;
+    int want_write;
+    int kick;           // tick worker žiada reaktor o odpojenie
+
+    // telemetria spojenia (metrics_add), nuluje sa pri prijatí
+    uint64_t bytes_sent;
+    uint64_t frames_sent;
+    uint64_t frames_dropped;    // stavy, ktoré klient nedostal (DropReason)
 } Client;
 
-typedef struct {
+// jedna nezávislá hra; game a members chráni mtx
+struct room {
+    int id;
     GameState game;
+    pthread_mutex_t mtx;
+    journal_t *journal;     // NULL = miestnosť sa nezaznamenáva (chráni mtx)
+
+    // schránky podľa player_id; pole mení len reaktor pod mtx, do schránok píše bez neho
+    inbox_t *inbox;
+    int inbox_cap;
+    uint64_t inputs_dropped;        // MOVE, ktoré sa nezmestili (píše reaktor, metrics_add)
+
+    int *members;       // indexy do clients[] (hráči aj diváci)
+    int num_members;
+    int members_cap;
 
-    Client clients[MAX_CLIENTS];
+    int worker;         // ktorý tick worker ju simuluje
+    int worker_slot;    // pozícia v jeho zozname
+
+    uint32_t seq;           // poradové číslo odoslaného stavu
+    StateBaseline base;     // čo klienti dostali naposledy (základ pre deltu)
+
+    // plán tickov (CLOCK_MONOTONIC), mení ho len worker pod mtx
+    struct timespec next_tick;
+    int scheduled;          // 0 = bez hráčov, nič sa neplánuje
+    int poke;               // treba poslať stav aj bez ticku (chráni mtx workera)
+    unsigned long overruns; // koľkokrát sa dobiehalo
+    unsigned long skipped;  // koľko tickov sa vynechalo
+};
+
+typedef struct {
+    struct server_ctx *S;
+    pthread_t thread;
+    pthread_mutex_t mtx;    // chráni rooms, drží sa počas celého ticku
+    pthread_cond_t cond;    // budí workera pred termínom (nová miestnosť, hráč)
+    room_t **rooms;
+    int num_rooms;
+    int rooms_cap;
+} tick_worker_t;
+
+// prečo klient nedostal stav
+typedef enum {
+    DROP_QUEUE_FULL,    // nezmestil sa do frontu
+    DROP_STALE,         // SLOW_LATEST ho vyhodil z frontu
+    DROP_THROTTLE,      // SLOW_THROTTLE vynechal tick
+    DROP_COUNT
+} DropReason;
+
+static const char *drop_reason_names[] = { "queue_full", "stale", "throttle" };
+
+// telemetria pre admin socket (-a), zapisujú ju workeri aj reaktor bez zámkov (metrics.h)
+typedef struct {
+    metrics_hist_t tick_ns;         // ticky miestnosti a rozoslanie stavu, pod r->mtx
+    metrics_hist_t simulate_ns;     // vstupy a game_tick
+    metrics_hist_t encode_ns;       // jedno zakódovanie stavu alebo výrezu
+    metrics_hist_t send_ns;         // jeden sendmsg v reaktore
+    metrics_hist_t lock_wait_ns;    // čakanie na r->mtx (workeri aj reaktor)
+    metrics_hist_t queue_depth;     // rámcov vo fronte spojenia po zaradení stavu
+    uint64_t bytes_sent;
+    uint64_t frames_sent;
+    uint64_t frames_dropped[DROP_COUNT];
+    uint64_t clients_kicked;
+    uint64_t connections;
+} server_metrics_t;
+
+// clients[] (okrem out buffrov) a rooms[] mení len vlákno reaktora
+typedef struct server_ctx {
+    Client clients[MAX_CONNECTIONS];
     int num_clients;
 
-    pthread_mutex_t mtx;
+    room_t **rooms;
+    int num_rooms;
+    int rooms_cap;
+    int next_room_id;
+
+    tick_worker_t *workers;
+    int num_workers;
+    pool_t *pool;           // fáza zámerov dvojfázového ticku, spoločný pre všetky miestnosti (NULL = vo workeri)
+
+    int keyframe_interval;  // každý koľký stav je celý, 0 = delta vypnutá
+    int tick_rate;          // predvolený pre nové miestnosti
+    int max_players;        // hráčov v jednej miestnosti
+    int view_size;          // predvolený výrez (strana v bunkách), 0 = vždy celá mapa
+    const char *journal_dir;    // NULL = bez žurnálov
+    SlowPolicy slow_policy;
+
     int running;
+
+    int epfd;
+    int wake_fd;
+
+    server_metrics_t metrics;
+    int admin_sock;         // -1 = admin socket vypnutý
+    pthread_t admin_thread;
 } server_ctx_t;
 
 
 
-static int snake_capacity(const Player *p) {
-    return (int)(sizeof(p->body_x) / sizeof(p->body_x[0]));
+// ---------- SIEŤ (epoll reaktor) ----------
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
-static int is_obstacle(const GameState *g, int x, int y) {
-    for (int i = 0; i < g->num_obstacles; i++) {
-        if (g->obstacles[i][0] == x && g->obstacles[i][1] == y) return 1;
+static void wake_reactor(server_ctx_t *S) {
+    uint64_t one = 1;
+    (void)write(S->wake_fd, &one, sizeof(one));
+}
+
+static void epoll_update(server_ctx_t *S, int idx, int want_write) {
+    Client *c = &S->clients[idx];
+    if (c->want_write == want_write) return;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | (want_write ? EPOLLOUT : 0);
+    ev.data.u32 = (uint32_t)idx;
+    epoll_ctl(S->epfd, EPOLL_CTL_MOD, c->socket, &ev);
+    c->want_write = want_write;
+}
+
+// ---------- ZDIEĽANÉ RÁMCE ----------
+
+static frame_t* frame_alloc(int cap) {
+    frame_t *f = (frame_t*)malloc(sizeof(frame_t) + (size_t)cap);
+    if (!f) return NULL;
+    f->refs = 1;
+    f->len = 0;
+    f->state = 0;
+    return f;
+}
+
+static void frame_unref(frame_t *f) {
+    if (f && __atomic_sub_fetch(&f->refs, 1, __ATOMIC_ACQ_REL) == 0) free(f);
+}
+
+// zaradí odkaz na rámec, bajty sa nekopírujú; vráti počet rámcov vo fronte, -1 = nezmestil sa
+static int client_queue_frame(Client *c, frame_t *f) {
+    int rc = -1;
+    pthread_mutex_lock(&c->out_mtx);
+    // keď sa rámec nezmestí, klient oň príde; kľúčový stav veľkej mapy môže byť väčší ako celý limit
+    if (c->outq && c->out_count < OUT_QUEUE_LEN && (c->out_count == 0 || c->out_bytes + f->len <= OUT_BUF_SIZE)) {
+        __atomic_add_fetch(&f->refs, 1, __ATOMIC_RELAXED);
+        c->outq[(c->out_head + c->out_count) % OUT_QUEUE_LEN] = f;
+        c->out_count++;
+        c->out_bytes += f->len;
+        rc = c->out_count;
     }
-    return 0;
+    pthread_mutex_unlock(&c->out_mtx);
+    return rc;
 }
 
-static void generate_obstacles_random(GameState *g, int count) {
-    g->num_obstacles = 0;
-    if (count > MAX_OBSTACLES) count = MAX_OBSTACLES;
+static int client_queue(Client *c, const char *data, int len) {
+    frame_t *f = frame_alloc(len);
+    if (!f) return -1;
+    memcpy(f->data, data, (size_t)len);
+    f->len = len;
+    int rc = client_queue_frame(c, f);
+    frame_unref(f);
+    return (rc < 0) ? -1 : 0;
+}
 
-    int attempts = 0;
-    while (g->num_obstacles < count && attempts < count * 3) {
-        int x = rand() % g->width;
-        int y = rand() % g->height;
+// klient nestíha, ak sa hromadí náš front alebo jeho socket v jadre
+static int client_backlogged(Client *c) {
+    pthread_mutex_lock(&c->out_mtx);
+    int n = c->out_count;
+    pthread_mutex_unlock(&c->out_mtx);
+    if (n >= SLOW_BACKLOG_FRAMES) return 1;
 
-        int valid = 1;
-        for (int i = 0; i < g->num_players; i++) {
-            if (g->players[i].head_x == x && g->players[i].head_y == y) {
-                valid = 0;
-                break;
-            }
+    int unsent = 0;
+    if (ioctl(c->socket, TIOCOUTQ, &unsent) == 0 && unsent > SLOW_BACKLOG_BYTES) return 1;
+    return 0;
+}
+
+// vyhodí z frontu neodoslané stavy, odpovede a rozposlaný rámec ostanú; vráti počet vyhodených
+static int client_drop_stale(Client *c) {
+    pthread_mutex_lock(&c->out_mtx);
+    int kept = 0, dropped = 0;
+    for (int i = 0; i < c->out_count; i++) {
+        frame_t *f = c->outq[(c->out_head + i) % OUT_QUEUE_LEN];
+        if (f->state && !(i == 0 && c->out_off > 0)) {
+            c->out_bytes -= f->len;
+            frame_unref(f);
+            dropped++;
+            continue;
         }
+        c->outq[(c->out_head + kept) % OUT_QUEUE_LEN] = f;
+        kept++;
+    }
+    c->out_count = kept;
+    pthread_mutex_unlock(&c->out_mtx);
+    return dropped;
+}
 
-        if (valid && !is_obstacle(g, x, y) && g->num_obstacles < MAX_OBSTACLES) {
-            g->obstacles[g->num_obstacles][0] = x;
-            g->obstacles[g->num_obstacles][1] = y;
-            g->num_obstacles++;
+// volá sa pod out_mtx
+static void client_drop_queue(Client *c) {
+    while (c->out_count > 0) {
+        frame_unref(c->outq[c->out_head]);
+        c->out_head = (c->out_head + 1) % OUT_QUEUE_LEN;
+        c->out_count--;
+    }
+    c->out_head = 0;
+    c->out_off = 0;
+    c->out_bytes = 0;
+}
+
+static int client_queue_str(Client *c, const char *msg) {
+    return client_queue(c, msg, (int)strlen(msg));
+}
+
+// krátka odpoveď servera v protokole, ktorým klient hovorí
+static void client_reply(Client *c, MessageType type, int value) {
+    if (c->binary) {
+        uint8_t buf[16];
+        wbuf_t w;
+        wbuf_init(&w, buf, (int)sizeof(buf));
+        proto_encode_u32(type, (uint32_t)value, &w);
+        (void)client_queue(c, (const char*)buf, w.len);
+        return;
+    }
+
+    char msg[64];
+    switch (type) {
+        case MSG_ASSIGN:      snprintf(msg, sizeof(msg), "ASSIGN|%d|\n", value); break;
+        case MSG_ROOM:        snprintf(msg, sizeof(msg), "ROOM|%d|\n", value); break;
+        case MSG_ROOM_ERR:    snprintf(msg, sizeof(msg), "ROOM_ERR|%d|\n", value); break;
+        case MSG_HELLO:       snprintf(msg, sizeof(msg), "HELLO|%d|\n", value); break;
+        case MSG_SERVER_FULL: snprintf(msg, sizeof(msg), "SERVER_FULL\n"); break;
+        default: return;
+    }
+    client_queue_str(c, msg);
+}
+
+// volá len reaktor, vráti -1 ak treba spojenie zavrieť
+static int client_flush(server_ctx_t *S, int idx) {
+    Client *c = &S->clients[idx];
+    int rc = 0, blocked = 0;
+
+    pthread_mutex_lock(&c->out_mtx);
+    while (c->out_count > 0) {
+        struct iovec iov[OUT_IOV_MAX];
+        int niov = 0;
+        for (int i = 0; i < c->out_count && niov < OUT_IOV_MAX; i++) {
+            frame_t *f = c->outq[(c->out_head + i) % OUT_QUEUE_LEN];
+            int skip = (i == 0) ? c->out_off : 0;
+            iov[niov].iov_base = f->data + skip;
+            iov[niov].iov_len = (size_t)(f->len - skip);
+            niov++;
         }
 
-        attempts++;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)niov;
+
+        uint64_t t0 = metrics_now_ns();
+        ssize_t n = sendmsg(c->socket, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        metrics_observe_since(&S->metrics.send_ns, t0);
+        if (n > 0) {
+            c->out_bytes -= (int)n;
+            metrics_add(&c->bytes_sent, (uint64_t)n);
+            metrics_add(&S->metrics.bytes_sent, (uint64_t)n);
+            // odoslané rámce pusti, posledný môže zostať rozposielaný
+            while (n > 0) {
+                frame_t *f = c->outq[c->out_head];
+                int left = f->len - c->out_off;
+                if (n < left) {
+                    c->out_off += (int)n;
+                    break;
+                }
+                n -= left;
+                frame_unref(f);
+                metrics_add(&c->frames_sent, 1);
+                metrics_add(&S->metrics.frames_sent, 1);
+                c->out_off = 0;
+                c->out_head = (c->out_head + 1) % OUT_QUEUE_LEN;
+                c->out_count--;
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            blocked = 1;
+            break;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        rc = -1;
+        break;
     }
+    pthread_mutex_unlock(&c->out_mtx);
+
+    if (rc == 0) epoll_update(S, idx, blocked);
+    return rc;
+}
 
-    fprintf(stderr, "[SERVER] %d prekážok vygenerovaných\n", g->num_obstacles);
+#define INT_CHARS 12    // "-2147483648|"
+
+// horná hranica dĺžky textového stavu aj s '\n' a '\0'
+static int text_state_size(const GameState *g) {
+    return 6 + 12 * INT_CHARS
+         + 3 + g->width * g->height
+         + g->num_obstacles * (2 + 2 * INT_CHARS)
+         + g->num_players * (2 + 7 * INT_CHARS + (int)sizeof(g->players[0].name))
+         + 2;
 }
 
+// textový STATE riadok (klienti bez binárneho protokolu), vráti dĺžku; cap >= text_state_size(g)
+static int format_text_state(const GameState *g, char *response, int cap) {
+    int off = 0;
 
-static int cell_occupied_by_snake(const GameState *g, int x, int y) {
+    off += snprintf(response + off, cap - off,
+        "STATE|%d|%d|%d|%d|%d|%d|%d|%d|%d|%d|%d|%d|",
+        g->id,
+        g->width,
+        g->height,
+        g->num_players,
+        g->fruit_x,
+        g->fruit_y,
+        g->active,
+        g->game_over,
+        g->num_obstacles,
+        g->mode,
+        g->world_type,
+        g->elapsed_time
+    );
+
+    // ---------- MAPA (VŽDY) ----------
+    response[off++] = 'M';
+    response[off++] = '|';
+    build_map(g, response + off);
+    off += g->width * g->height;
+    response[off++] = '|';
+
+    // ---------- PREKÁŽKY ----------
+    for (int i = 0; i < g->num_obstacles; i++) {
+        off += snprintf(response + off, cap - off,
+            "O|%d|%d|",
+            g->obstacles[i][0],
+            g->obstacles[i][1]
+        );
+    }
+
+    // ---------- HRÁČI ----------
     for (int i = 0; i < g->num_players; i++) {
         const Player *p = &g->players[i];
-        if (!p->alive) continue;
-        for (int j = 0; j < p->body_len; j++) {
-            if (p->body_x[j] == x && p->body_y[j] == y) return 1;
-        }
+        off += snprintf(response + off, cap - off,
+            "P|%d|%s|%d|%d|%d|%d|%d|%d|",
+            p->id,
+            p->name,
+            player_alive(g, i),
+            p->score,
+            g->head_x[i],
+            g->head_y[i],
+            (int)g->body_len[i],
+            player_dir(g, i)
+        );
     }
-    return 0;
+
+    // ---------- KONIEC RIADKU ----------
+    response[off++] = '\n';
+    response[off] = '\0';
+    return off;
 }
- 
-static int cell_occupied_by_fruit(const GameState *g, int x, int y) {
-    for (int i = 0; i < g->num_fruits; i++) {
-        if (g->fruits[i][0] == x && g->fruits[i][1] == y) return 1;
+
+// ---------- MIESTNOSTI ----------
+
+// mtx miestnosti s meraním čakania
+static void room_lock(server_ctx_t *S, room_t *r) {
+    metrics_lock(&r->mtx, &S->metrics.lock_wait_ns);
+}
+
+static room_t* find_room(server_ctx_t *S, int id) {
+    for (int i = 0; i < S->num_rooms; i++) {
+        if (S->rooms[i]->id == id) return S->rooms[i];
     }
+    return NULL;
+}
+
+static int grow_array(void **arr, int *cap, int need, size_t elem) {
+    if (need <= *cap) return 0;
+    int ncap = *cap ? *cap * 2 : 8;
+    while (ncap < need) ncap *= 2;
+    void *n = realloc(*arr, (size_t)ncap * elem);
+    if (!n) return -1;
+    *arr = n;
+    *cap = ncap;
     return 0;
 }
- 
-static int alive_snakes(const GameState *g) {
-    int c = 0;
-    for (int i = 0; i < g->num_players; i++) {
-        if (g->players[i].alive) c++;
+
+static room_t* room_create(server_ctx_t *S, int w, int h, GameMode mode, int time_limit, WorldType world_type,
+                           int tick_rate, TickMode tick_mode) {
+    if (grow_array((void**)&S->rooms, &S->rooms_cap, S->num_rooms + 1, sizeof(room_t*)) < 0) return NULL;
+
+    room_t *r = (room_t*)calloc(1, sizeof(room_t));
+    if (!r) return NULL;
+
+    // seed z hodín a id miestnosti, dve miestnosti v tej istej nanosekunde sa nezhodujú
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t seed = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    seed ^= (uint64_t)S->next_room_id << 48;
+
+    if (init_game(&r->game, w, h, mode, time_limit, world_type, seed) < 0) {
+        game_free(&r->game);
+        free(r);
+        return NULL;
     }
-    return c;
+    r->id = S->next_room_id++;
+    pthread_mutex_init(&r->mtx, NULL);
+    r->game.id = r->id;
+
+    if (tick_rate <= 0) tick_rate = S->tick_rate;
+    if (tick_rate < MIN_TICK_RATE) tick_rate = MIN_TICK_RATE;
+    if (tick_rate > MAX_TICK_RATE) tick_rate = MAX_TICK_RATE;
+    r->game.tick_rate = tick_rate;
+    r->game.tick_mode = (tick_mode == TICK_TWO_PHASE) ? TICK_TWO_PHASE : TICK_SEQUENTIAL;
+
+    if (S->journal_dir) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/room-%d-%016llx.hadj", S->journal_dir, r->id, (unsigned long long)seed);
+        r->journal = journal_create(path, &r->game);
+        if (!r->journal) fprintf(stderr, "[SERVER] Žurnál %s sa nepodarilo vytvoriť\n", path);
+    }
+
+    // miestnosti sa rozhadzujú medzi workerov podľa id
+    tick_worker_t *W = &S->workers[r->id % S->num_workers];
+    pthread_mutex_lock(&W->mtx);
+    if (grow_array((void**)&W->rooms, &W->rooms_cap, W->num_rooms + 1, sizeof(room_t*)) < 0) {
+        pthread_mutex_unlock(&W->mtx);
+        pthread_mutex_destroy(&r->mtx);
+        game_free(&r->game);
+        free(r);
+        return NULL;
+    }
+    r->worker = r->id % S->num_workers;
+    r->worker_slot = W->num_rooms;
+    W->rooms[W->num_rooms++] = r;
+    pthread_mutex_unlock(&W->mtx);
+
+    S->rooms[S->num_rooms++] = r;
+
+    fprintf(stderr, "[SERVER] Miestnosť %d vytvorená (worker %d, %d tickov/s, %s, miestností: %d)\n",
+            r->id, r->worker, r->game.tick_rate,
+            r->game.tick_mode == TICK_TWO_PHASE ? "dvojfázový tick" : "tick po poradí", S->num_rooms);
+    return r;
 }
- 
-static void sync_legacy_fruit_xy(GameState *g) {
-    if (g->num_fruits > 0) {
-        g->fruit_x = g->fruits[0][0];
-        g->fruit_y = g->fruits[0][1];
-    } else {
-        g->fruit_x = -1;
-        g->fruit_y = -1;
+
+static void room_destroy(server_ctx_t *S, room_t *r) {
+    tick_worker_t *W = &S->workers[r->worker];
+    pthread_mutex_lock(&W->mtx);
+    room_t *last = W->rooms[--W->num_rooms];
+    W->rooms[r->worker_slot] = last;
+    last->worker_slot = r->worker_slot;
+    pthread_mutex_unlock(&W->mtx);
+
+    for (int i = 0; i < S->num_rooms; i++) {
+        if (S->rooms[i] == r) {
+            S->rooms[i] = S->rooms[--S->num_rooms];
+            break;
+        }
     }
+
+    fprintf(stderr, "[SERVER] Miestnosť %d zrušená (miestností: %d, zahodených vstupov: %llu)\n", r->id,
+            S->num_rooms, (unsigned long long)metrics_get(&r->inputs_dropped));
+
+    pthread_mutex_destroy(&r->mtx);
+    journal_close(r->journal);
+    free(r->inbox);
+    game_free(&r->game);
+    proto_baseline_free(&r->base);
+    free(r->members);
+    free(r);
 }
- 
-static void spawn_fruit_at(GameState *g, int idx) {
-    int x, y;
-    int tries = 3000;
- 
-    do {
-        x = rand() % g->width;
-        y = rand() % g->height;
-        tries--;
-    } while (
-        tries > 0 &&
-        (is_obstacle(g, x, y) ||
-         cell_occupied_by_snake(g, x, y) ||
-         cell_occupied_by_fruit(g, x, y))
-    );
- 
-    if (tries <= 0) { x = 0; y = 0; }
- 
-    g->fruits[idx][0] = x;
-    g->fruits[idx][1] = y;
- 
-    sync_legacy_fruit_xy(g);
- 
-    fprintf(stderr, "[SERVER] Ovocie[%d] vygenerované: (%d, %d)\n", idx, x, y);
+
+static int room_join(server_ctx_t *S, room_t *r, int cidx) {
+    room_lock(S, r);
+    int rc = grow_array((void**)&r->members, &r->members_cap, r->num_members + 1, sizeof(int));
+    if (rc == 0) {
+        r->members[r->num_members++] = cidx;
+        S->clients[cidx].need_keyframe = 1;
+        S->clients[cidx].have_view = 0;
+    }
+    pthread_mutex_unlock(&r->mtx);
+    return rc;
 }
- 
-static void ensure_fruits_count(GameState *g) {
-    int want = alive_snakes(g);
-    if (want > MAX_FRUITS) want = MAX_FRUITS;
- 
-    while (g->num_fruits < want) {
-        spawn_fruit_at(g, g->num_fruits);
-        g->num_fruits++;
+
+// odíde z miestnosti (hadík zomrie), prázdna miestnosť zanikne
+static void room_leave(server_ctx_t *S, int cidx) {
+    Client *c = &S->clients[cidx];
+    room_t *r = c->room;
+    if (!r) return;
+
+    room_lock(S, r);
+    for (int i = 0; i < r->num_members; i++) {
+        if (r->members[i] == cidx) {
+            r->members[i] = r->members[--r->num_members];
+            break;
+        }
     }
- 
-    while (g->num_fruits > want) {
-        g->num_fruits--;
+
+    int pid = c->player_id;
+    if (pid >= 0 && pid < r->game.num_players) {
+        kill_snake(&r->game, pid);
+        ensure_fruits_count(&r->game);
+        journal_kill(r->journal, pid);
     }
- 
-    sync_legacy_fruit_xy(g);
+    int empty = (r->num_members == 0);
+    pthread_mutex_unlock(&r->mtx);
+
+    c->room = NULL;
+    c->player_id = -1;
+
+    if (empty) room_destroy(S, r);
 }
 
-static void init_game(GameState *g, int width, int height, GameMode mode, int time_limit, WorldType world_type) {
-    g->id = rand() % 10000;
-    g->width = width;
-    g->height = height;
-    g->num_players = 0;
-    g->mode = mode;
-    g->time_limit = time_limit;
-    g->elapsed_time = 0;
-    g->active = 0;
-    g->game_over = 0;
-    g->world_type = world_type;
-    g->start_time = time(NULL);
+// ---------- VSTUPY HRÁČOV ----------
+
+// schránky aspoň pre need hráčov, volá reaktor pod mtx miestnosti
+static int inbox_reserve(room_t *r, int need) {
+    int old = r->inbox_cap;
+    if (grow_array((void**)&r->inbox, &r->inbox_cap, need, sizeof(inbox_t)) < 0) return -1;
+    memset(r->inbox + old, 0, (size_t)(r->inbox_cap - old) * sizeof(inbox_t));
+    return 0;
+}
 
-    g->num_obstacles = 0;
-    if (world_type == WORLD_WITH_OBSTACLES) {
-        int obstacle_count = (width * height) / 8;
-        generate_obstacles_random(g, obstacle_count);
+// reaktor: vloží MOVE bez čakania na tick, -1 = schránka je plná
+static int inbox_push(inbox_t *b, Direction dir, uint32_t seq) {
+    uint32_t tail = b->tail;
+    if (tail - __atomic_load_n(&b->head, __ATOMIC_ACQUIRE) >= INBOX_LEN) return -1;
+    b->dir[tail % INBOX_LEN] = (uint8_t)dir;
+    b->seq[tail % INBOX_LEN] = seq;
+    __atomic_store_n(&b->tail, tail + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// čakajúci QUIT hráča pid (pod mtx): hadík zomrie
+static void room_take_quit(room_t *r, int pid) {
+    inbox_t *b = &r->inbox[pid];
+    if (__atomic_load_n(&b->quit, __ATOMIC_RELAXED) && __atomic_exchange_n(&b->quit, 0, __ATOMIC_ACQ_REL)) {
+        kill_snake(&r->game, pid);
+        ensure_fruits_count(&r->game);
+        journal_kill(r->journal, pid);
     }
+}
 
-    g->num_fruits = 0;
-    ensure_fruits_count(g);
+// slot pre hadíka klienta c (reaktor pod mtx): jeho vlastný, inak mŕtvy slot, ktorý nedrží žiadne
+// spojenie (hráč odišiel), inak nový na konci; num_players tak nepresiahne max_players ani
+// pri neustálom odchádzaní a pripájaní. -1 = nedostatok pamäte
+static int room_pick_slot(server_ctx_t *S, room_t *r, const Client *c) {
+    GameState *g = &r->game;
+    if (c->player_id >= 0 && c->player_id < g->num_players) return c->player_id;
+
+    uint8_t *held = (uint8_t*)calloc((size_t)g->num_players + 1, 1);
+    if (!held) return -1;
+    for (int i = 0; i < r->num_members; i++) {
+        int pid = S->clients[r->members[i]].player_id;
+        if (pid >= 0 && pid < g->num_players) held[pid] = 1;
+    }
+    int slot = g->num_players;
+    for (int i = 0; i < g->num_players; i++) {
+        if (!held[i] && !player_alive(g, i)) {
+            slot = i;
+            break;
+        }
+    }
+    free(held);
+    return slot;
+}
+
+// tick pod mtx: každému hráčovi najviac jedna otočka za tick, ostatné počkajú na ďalšie ticky,
+// takže rýchla kombinácia (hore a hneď doľava) sa nestratí. MOVE bez zmeny smeru nie je otočka,
+// len posunie potvrdený input_seq. Rovnaké poradie ide aj do žurnálu.
+static void room_drain_inputs(room_t *r) {
+    GameState *g = &r->game;
+    int n = (g->num_players < r->inbox_cap) ? g->num_players : r->inbox_cap;
+
+    for (int pid = 0; pid < n; pid++) {
+        inbox_t *b = &r->inbox[pid];
+        uint32_t head = b->head;
+        uint32_t tail = __atomic_load_n(&b->tail, __ATOMIC_ACQUIRE);
+        int turned = 0;
+        for (; head != tail && !turned; head++) {
+            if (!player_alive(g, pid)) continue;
+            Direction dir = (Direction)b->dir[head % INBOX_LEN];
+            uint32_t seq = b->seq[head % INBOX_LEN];
+            turned = (dir != player_next_dir(g, pid));
+            player_set_next_dir(g, pid, dir);
+            if (seq) g->next_seq[pid] = seq;
+            journal_move(r->journal, pid, dir, seq);
+        }
+        __atomic_store_n(&b->head, head, __ATOMIC_RELEASE);
 
-    fprintf(stderr, "[SERVER] Hra inicializovaná: %dx%d, režim: %d, svet: %d\n",
-            width, height, mode, world_type);
+        room_take_quit(r, pid);
+    }
 }
 
-static int init_snake(GameState *g, int player_id, const char *name) {
-    if (g->num_players >= 10) return -1;
+static void room_tick(server_ctx_t *S, room_t *r) {
+    uint64_t t0 = metrics_now_ns();
+    room_drain_inputs(r);
+    GameTickResult res = game_tick_pool(&r->game, S->pool);
+    metrics_observe_since(&S->metrics.simulate_ns, t0);
+    if (res != GAME_TICK_IDLE) journal_tick(r->journal, &r->game);
+    if (res == GAME_TICK_TIME_UP) {
+        fprintf(stderr, "[SERVER] Miestnosť %d: čas vypršal! KONIEC HRY!\n", r->id);
+    }
+}
 
-    Player *p = &g->players[g->num_players];
-    p->id = player_id;
-    p->alive = 1;
-    p->score = 0;
+enum { ENC_TEXT, ENC_KEY, ENC_DELTA, ENC_COUNT };
 
-    strncpy(p->name, name, sizeof(p->name) - 1);
-    p->name[sizeof(p->name) - 1] = '\0';
+// zakóduje aktuálny stav miestnosti do nového zdieľaného rámca, veľkého presne na hornú hranicu stavu
+static frame_t* room_encode(room_t *r, int kind) {
+    int cap = (kind == ENC_TEXT) ? text_state_size(&r->game)
+            : (kind == ENC_KEY)  ? proto_state_size(&r->game)
+                                 : proto_delta_size(&r->game);
+    frame_t *f = frame_alloc(cap);
+    if (!f) return NULL;
 
-    p->direction = RIGHT;
-    p->next_direction = RIGHT;
+    if (kind == ENC_TEXT) {
+        f->len = format_text_state(&r->game, f->data, cap);
+    } else {
+        wbuf_t w;
+        wbuf_init(&w, f->data, cap);
+        int rc = (kind == ENC_KEY) ? proto_encode_state(&r->game, r->seq, &w)
+                                   : proto_encode_delta(&r->game, &r->base, r->seq, &w);
+        f->len = (rc == 0) ? w.len : 0;
+    }
 
-    p->head_x = 5 + g->num_players * 5;
-    if (p->head_x < 0) p->head_x = 0;
-    if (p->head_x >= g->width) p->head_x = g->width / 2;
+    if (f->len <= 0) {
+        frame_unref(f);
+        return NULL;
+    }
+    f->state = 1;
+    return f;
+}
 
-    p->head_y = g->height / 2;
+// ---------- VÝREZ ----------
 
-    int cap = snake_capacity(p);
-    p->body_len = INITIAL_SNAKE_LEN;
-    if (p->body_len > cap) p->body_len = cap;
+#define VIEW_MARGIN_DIV 4   // kamera sa hýbe, až keď je hlava v krajnej štvrtine výrezu
+#define VIEW_CACHE 32       // rôznych výrezov zakódovaných raz za tick
 
-    for (int i = 0; i < p->body_len; i++) {
-        int bx = p->head_x - i;
-        if (bx < 0) bx += g->width;
-        if (bx >= g->width) bx %= g->width;
+// nová poloha ľavého okraja výrezu dĺžky len na osi s dĺžkou size tak, aby pos bola v strede
+static int view_center(int pos, int len, int size) {
+    int x = pos - len / 2;
+    if (x > size - len) x = size - len;
+    return (x < 0) ? 0 : x;
+}
 
-        p->body_x[i] = bx;
-        p->body_y[i] = p->head_y;
+// posunie kameru klienta; 0 = celá mapa sa zmestí do výrezu a klient dostáva obyčajné stavy
+static int client_update_view(server_ctx_t *S, Client *c, const GameState *g) {
+    int vw = c->view_w ? c->view_w : S->view_size;
+    int vh = c->view_h ? c->view_h : S->view_size;
+    if (vw <= 0 || vh <= 0 || (vw >= g->width && vh >= g->height)) return 0;
+    if (vw > g->width) vw = g->width;
+    if (vh > g->height) vh = g->height;
+
+    ViewRect *v = &c->view;
+    int pid = c->player_id;
+    if (pid < 0 || pid >= g->num_players) {
+        // divák má kameru pevne v strede mapy
+        v->x = (g->width - vw) / 2;
+        v->y = (g->height - vh) / 2;
+    } else {
+        // hráč: kamera sa nastaví na hlavu až pri vstupe do okrajového pásu, nie každý tick
+        int hx = g->head_x[pid], hy = g->head_y[pid];
+        int mx = vw / VIEW_MARGIN_DIV, my = vh / VIEW_MARGIN_DIV;
+        int fresh = !c->have_view || v->w != vw || v->h != vh;
+        if (fresh || hx < v->x + mx || hx >= v->x + vw - mx) v->x = view_center(hx, vw, g->width);
+        if (fresh || hy < v->y + my || hy >= v->y + vh - my) v->y = view_center(hy, vh, g->height);
     }
+    v->w = vw;
+    v->h = vh;
+    c->have_view = 1;
+    return 1;
+}
 
-    g->num_players++;
-    if (g->num_players == 1) {
-        g->active = 1;
-        g->game_over = 0;
-        g->start_time = time(NULL);
+static frame_t* room_encode_view(room_t *r, const ViewRect *v) {
+    int cap = proto_view_size(&r->game, v);
+    frame_t *f = frame_alloc(cap);
+    if (!f) return NULL;
+
+    wbuf_t w;
+    wbuf_init(&w, f->data, cap);
+    if (proto_encode_view(&r->game, v, r->seq, &w) < 0) {
+        frame_unref(f);
+        return NULL;
     }
+    f->len = w.len;
+    f->state = 1;
+    return f;
+}
 
-    fprintf(stderr, "[SERVER] Hadík '%s' vytvorený (ID: %d)\n", p->name, player_id);
-    ensure_fruits_count(g);
-    return player_id;
+// klienti s rovnakým výrezom (diváci, hadíky blízko seba) dostanú ten istý rámec
+typedef struct {
+    ViewRect rect;
+    frame_t *frame;
+} view_cache_t;
+
+// *own = 1: rámec sa do cache nezmestil a volajúci ho po zaradení uvoľní
+static frame_t* view_frame(server_ctx_t *S, room_t *r, view_cache_t *cache, int *n, const ViewRect *v, int *own) {
+    *own = 0;
+    for (int i = 0; i < *n; i++) {
+        const ViewRect *q = &cache[i].rect;
+        if (q->x == v->x && q->y == v->y && q->w == v->w && q->h == v->h) return cache[i].frame;
+    }
+    uint64_t t0 = metrics_now_ns();
+    frame_t *f = room_encode_view(r, v);
+    metrics_observe_since(&S->metrics.encode_ns, t0);
+    if (!f) return NULL;
+    if (*n == VIEW_CACHE) {
+        *own = 1;
+        return f;
+    }
+    cache[*n].rect = *v;
+    cache[(*n)++].frame = f;
+    return f;
 }
 
-static void update_snake(GameState *g, Player *p) {
-    if (!p->alive) return;
+static void client_count_drop(server_ctx_t *S, Client *c, DropReason why, int frames) {
+    if (frames <= 0) return;
+    metrics_add(&S->metrics.frames_dropped[why], (uint64_t)frames);
+    metrics_add(&c->frames_dropped, (uint64_t)frames);
+}
 
-    p->direction = p->next_direction;
+// depth = výsledok client_queue_frame
+static void client_count_queued(server_ctx_t *S, Client *c, int depth) {
+    if (depth < 0) client_count_drop(S, c, DROP_QUEUE_FULL, 1);
+    else metrics_observe(&S->metrics.queue_depth, (uint64_t)depth);
+}
 
-    int new_x = p->head_x;
-    int new_y = p->head_y;
+// pošle stav po ticku všetkým členom, mimo ticku (tick == 0) len tým, čo čakajú na celý stav;
+// volá sa pod r->mtx
+static void room_broadcast(server_ctx_t *S, room_t *r, int tick) {
+    if (tick) r->seq++;
+
+    // každá podoba stavu sa kóduje najviac raz za tick a členovia dostanú len odkaz
+    frame_t *enc[ENC_COUNT] = { NULL };
+    int tried[ENC_COUNT] = { 0 };
+    view_cache_t views[VIEW_CACHE];
+    int num_views = 0;
+    int key_tick = (S->keyframe_interval <= 0) || (r->seq % (uint32_t)S->keyframe_interval == 0);
+    // veľa zmenených buniek naraz (smrť dlhých hadov) by deltu natiahlo nad PROTO_MAX_FRAME, kľúčový rámec sa zmestí vždy
+    int delta_big = proto_delta_size(&r->game) > PROTO_MAX_FRAME;
+
+    for (int i = 0; i < r->num_members; i++) {
+        Client *c = &S->clients[r->members[i]];
+        if (!tick && !c->need_keyframe) continue;
+
+        // pomalý klient nesmie brzdiť ostatných ani donekonečna hromadiť stavy
+        if (client_backlogged(c)) {
+            if (S->slow_policy == SLOW_KICK) {
+                __atomic_store_n(&c->kick, 1, __ATOMIC_RELEASE);
+                continue;
+            }
+            c->need_keyframe = 1;
+            if (S->slow_policy == SLOW_THROTTLE) {
+                client_count_drop(S, c, DROP_THROTTLE, 1);
+                continue;
+            }
+            client_count_drop(S, c, DROP_STALE, client_drop_stale(c));
+        }
 
-    switch (p->direction) {
-        case UP:    new_y--; break;
-        case DOWN:  new_y++; break;
-        case LEFT:  new_x--; break;
-        case RIGHT: new_x++; break;
-        case NONE:  break;
-    }
+        // veľká mapa: len výrez okolo hadíka, každý výrez je samostatný stav
+        if (c->binary && client_update_view(S, c, &r->game)) {
+            int own;
+            frame_t *f = view_frame(S, r, views, &num_views, &c->view, &own);
+            int depth = f ? client_queue_frame(c, f) : -1;
+            c->need_keyframe = (depth < 0);
+            client_count_queued(S, c, depth);
+            if (own) frame_unref(f);
+            continue;
+        }
 
-    if (g->world_type == WORLD_NO_OBSTACLES) {
-        if (new_x < 0) new_x = g->width - 1;
-        if (new_x >= g->width) new_x = 0;
-        if (new_y < 0) new_y = g->height - 1;
-        if (new_y >= g->height) new_y = 0;
-    } else {
-        if (new_x < 0 || new_x >= g->width || new_y < 0 || new_y >= g->height) {
-            p->alive = 0;
-            fprintf(stderr, "[SERVER] Hadík '%s' narazil do okraja!\n", p->name);
-            return;
+        int kind = !c->binary ? ENC_TEXT : (key_tick || c->need_keyframe || delta_big) ? ENC_KEY : ENC_DELTA;
+
+        if (!tried[kind]) {
+            uint64_t t0 = metrics_now_ns();
+            enc[kind] = room_encode(r, kind);
+            metrics_observe_since(&S->metrics.encode_ns, t0);
+            tried[kind] = 1;
         }
+
+        int rc = enc[kind] ? client_queue_frame(c, enc[kind]) : -1;
+        client_count_queued(S, c, rc);
+        if (kind != ENC_DELTA && rc >= 0) c->need_keyframe = 0;
+        // stratená delta by rozbila reťaz, klient potom dostane celý stav
+        if (kind == ENC_DELTA && rc < 0) c->need_keyframe = 1;
     }
 
-    if (is_obstacle(g, new_x, new_y)) {
-        p->alive = 0;
-        fprintf(stderr, "[SERVER] Hadík '%s' narazil do prekážky!\n", p->name);
-        return;
+    for (int k = 0; k < ENC_COUNT; k++) frame_unref(enc[k]);
+    for (int k = 0; k < num_views; k++) frame_unref(views[k].frame);
+
+    // mimo ticku sa základ delty nemení, zmeny odídu v ďalšej delte
+    if (!tick) return;
+    proto_baseline_update(&r->base, &r->game, r->seq);
+    dirty_clear(&r->game);
+}
+
+static int room_count_players(const room_t *r, const server_ctx_t *S) {
+    int c = 0;
+    for (int i = 0; i < r->num_members; i++) {
+        if (S->clients[r->members[i]].player_id >= 0) c++;
     }
+    return c;
+}
 
-    for (int i = 0; i < p->body_len - 1; i++) {
-        if (p->body_x[i] == new_x && p->body_y[i] == new_y) {
-            p->alive = 0;
-            fprintf(stderr, "[SERVER] Hadík '%s' narazil sám do seba!\n", p->name);
-            return;
-        }
-      }
+// ---------- PLÁNOVAČ TICKOV ----------
 
-    for (int i = 0; i < g->num_players; i++) {
-        if (g->players[i].id == p->id) continue;
-        if (!g->players[i].alive) continue;
-        for (int j = 0; j < g->players[i].body_len; j++) {
-            if (g->players[i].body_x[j] == new_x && g->players[i].body_y[j] == new_y) {
-                p->alive = 0;
-                fprintf(stderr, "[SERVER] Hadík '%s' narazil do iného hadíka!\n", p->name);
-                return;
-            }
-        }
+#define TICK_MAX_CATCHUP 3  // koľko zmeškaných tickov sa dobehne naraz, zvyšok sa vynechá
+
+// odsimuluje ticky, ktorých termín už nastal; volá sa pod mtx workera aj miestnosti
+static int room_run_due(server_ctx_t *S, room_t *r, const struct timespec *now) {
+    if (room_count_players(r, S) == 0) {
+        r->scheduled = 0;
+        return 0;
+    }
+    if (!r->scheduled) {
+        r->next_tick = *now;
+        r->scheduled = 1;
     }
 
-    for (int i = p->body_len - 1; i > 0; i--) {
-        p->body_x[i] = p->body_x[i - 1];
-        p->body_y[i] = p->body_y[i - 1];
+    long long period = NSEC_PER_SEC / r->game.tick_rate;
+    int done = 0;
+    while (done < TICK_MAX_CATCHUP && ts_diff_ns(now, &r->next_tick) >= 0) {
+        room_tick(S, r);
+        ts_add_ns(&r->next_tick, period);
+        done++;
     }
+    if (done > 1) r->overruns++;
+
+    // čo sa nedobehlo, sa vynechá celými periódami, aby termíny zostali v mriežke
+    long long late = ts_diff_ns(now, &r->next_tick);
+    if (late >= 0) {
+        long long skip = late / period + 1;
+        ts_add_ns(&r->next_tick, skip * period);
+        r->skipped += (unsigned long)skip;
+        fprintf(stderr, "[SERVER] Miestnosť %d nestíha, vynechaných tickov: %lld\n", r->id, skip);
+    }
+    return done;
+}
 
-    p->head_x = new_x;
-    p->head_y = new_y;
-    p->body_x[0] = new_x;
-    p->body_y[0] = new_y;
+// zobudí workera miestnosti, nesmie sa volať pod r->mtx
+static void room_poke(server_ctx_t *S, room_t *r) {
+    tick_worker_t *W = &S->workers[r->worker];
+    pthread_mutex_lock(&W->mtx);
+    r->poke = 1;
+    pthread_cond_signal(&W->cond);
+    pthread_mutex_unlock(&W->mtx);
+}
 
-    for (int f = 0; f < g->num_fruits; f++) {
-        if (p->head_x == g->fruits[f][0] && p->head_y == g->fruits[f][1]) {
-            p->score += 10;
- 
-            int cap = snake_capacity(p);
-            if (p->body_len < cap) p->body_len++;
- 
-            fprintf(stderr, "[SERVER] Hadík '%s' zjedol ovocie[%d]! Body: %d\n", p->name, f, p->score);
-            spawn_fruit_at(g, f);
-            break;
+static void* tick_worker_loop(void *arg) {
+    tick_worker_t *W = (tick_worker_t*)arg;
+    server_ctx_t *S = W->S;
+
+    pthread_mutex_lock(&W->mtx);
+    while (S->running) {
+        struct timespec now, wake;
+        int have_wake = 0, queued = 0;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        for (int k = 0; k < W->num_rooms; k++) {
+            room_t *r = W->rooms[k];
+
+            room_lock(S, r);
+            uint64_t t0 = metrics_now_ns();
+            if (room_run_due(S, r, &now) > 0) {
+                room_broadcast(S, r, 1);
+                metrics_observe_since(&S->metrics.tick_ns, t0);
+                if (r->num_members > 0) queued = 1;
+            } else if (r->poke) {
+                room_broadcast(S, r, 0);
+                queued = 1;
+            }
+            r->poke = 0;
+            if (r->scheduled && (!have_wake || ts_diff_ns(&wake, &r->next_tick) > 0)) {
+                wake = r->next_tick;
+                have_wake = 1;
+            }
+            pthread_mutex_unlock(&r->mtx);
         }
-    }    
+
+        // samotné posielanie robí reaktor
+        if (queued) wake_reactor(S);
+
+        // spí do najbližšieho termínu, bez hráčov kým ho niekto nezobudí
+        if (have_wake) pthread_cond_timedwait(&W->cond, &W->mtx, &wake);
+        else pthread_cond_wait(&W->cond, &W->mtx);
+    }
+    pthread_mutex_unlock(&W->mtx);
+
+    return NULL;
 }
 
-static void build_map(const GameState *g, char *out) {
-    int k = 0;
+// presunie klienta do miestnosti r
+static int client_enter_room(server_ctx_t *S, int cidx, room_t *r) {
+    Client *c = &S->clients[cidx];
+    if (c->room == r) return 0;
 
-    for (int y = 0; y < g->height; y++)
-        for (int x = 0; x < g->width; x++)
-            out[k++] = '.';
+    // ak by pôvodná miestnosť zanikla, r už môže byť uvoľnená - preto najprv join
+    if (room_join(S, r, cidx) < 0) return -1;
+    room_leave(S, cidx);
+    c->room = r;
 
-    for (int i = 0; i < g->num_obstacles; i++) {
-        int x = g->obstacles[i][0], y = g->obstacles[i][1];
-        if (x >= 0 && x < g->width && y >= 0 && y < g->height)
-            out[y * g->width + x] = '#';
+    client_reply(c, MSG_ROOM, r->id);
+    // nový člen dostane stav hneď, aj keď sa v miestnosti zatiaľ nehrá
+    room_poke(S, r);
+    return 0;
+}
+
+#define MAX_LISTED_ROOMS 256
+
+static void send_room_list(server_ctx_t *S, Client *c) {
+    RoomInfo list[MAX_LISTED_ROOMS];
+    int count = 0;
+
+    for (int i = 0; i < S->num_rooms && count < MAX_LISTED_ROOMS; i++) {
+        room_t *r = S->rooms[i];
+        RoomInfo *ri = &list[count++];
+
+        room_lock(S, r);
+        ri->id = r->id;
+        ri->players = room_count_players(r, S);
+        ri->max_players = S->max_players;
+        ri->width = r->game.width;
+        ri->height = r->game.height;
+        ri->mode = r->game.mode;
+        ri->world_type = r->game.world_type;
+        pthread_mutex_unlock(&r->mtx);
     }
 
-    for (int i = 0; i < g->num_fruits; i++) {
-        int fx = g->fruits[i][0], fy = g->fruits[i][1];
-        if (fx >= 0 && fx < g->width && fy >= 0 && fy < g->height)
-            out[fy * g->width + fx] = '*';
-    }  
+    // zoznam sa zmestí vždy celý: hlavička + MAX_LISTED_ROOMS záznamov po 7 číslach
+    char resp[8 + INT_CHARS + MAX_LISTED_ROOMS * (2 + 7 * INT_CHARS)];
+    if (c->binary) {
+        wbuf_t w;
+        wbuf_init(&w, resp, (int)sizeof(resp));
+        if (proto_encode_rooms(list, count, S->num_rooms, &w) == 0) (void)client_queue(c, resp, w.len);
+        return;
+    }
 
+    int off = snprintf(resp, sizeof(resp), "ROOMS|%d|", S->num_rooms);
+    for (int i = 0; i < count; i++) {
+        off += snprintf(resp + off, sizeof(resp) - (size_t)off, "R|%d|%d|%d|%d|%d|%d|%d|",
+                        list[i].id, list[i].players, list[i].width, list[i].height,
+                        list[i].mode, list[i].world_type, list[i].max_players);
+    }
 
-    for (int i = 0; i < g->num_players; i++) {
-        const Player *p = &g->players[i];
-        if (!p->alive) continue;
+    resp[off++] = '\n';
+    (void)client_queue(c, resp, off);
+}
 
-        for (int j = 1; j < p->body_len; j++) {
-            int x = p->body_x[j], y = p->body_y[j];
-            if (x >= 0 && x < g->width && y >= 0 && y < g->height)
-                out[y * g->width + x] = '~';
+// spracuje jeden príkaz klienta (vlákno reaktora); vráti -1 ak sa má spojenie zavrieť
+static int handle_command(server_ctx_t *S, int cidx, const Message *m) {
+    Client *c = &S->clients[cidx];
+
+    switch (m->type) {
+    case MSG_HELLO:
+        // odpoveď ešte textom, potom už oba smery binárne
+        if (!c->binary && m->args[0] >= PROTO_VERSION) {
+            client_reply(c, MSG_HELLO, PROTO_VERSION);
+            if (c->room) room_lock(S, c->room);
+            c->binary = 1;
+            c->need_keyframe = 1;
+            if (c->room) {
+                pthread_mutex_unlock(&c->room->mtx);
+                room_poke(S, c->room);
+            }
         }
+        break;
+
+    case MSG_VIEW: {
+        // 0 = predvolený výrez servera, inak sa oreže na VIEW_MIN..VIEW_MAX
+        int vw = m->args[0], vh = m->args[1];
+        if (vw) vw = (vw < VIEW_MIN) ? VIEW_MIN : (vw > VIEW_MAX) ? VIEW_MAX : vw;
+        if (vh) vh = (vh < VIEW_MIN) ? VIEW_MIN : (vh > VIEW_MAX) ? VIEW_MAX : vh;
+
+        if (c->room) room_lock(S, c->room);
+        c->view_w = vw;
+        c->view_h = vh;
+        c->have_view = 0;
+        c->need_keyframe = 1;
+        if (c->room) {
+            pthread_mutex_unlock(&c->room->mtx);
+            room_poke(S, c->room);
+        }
+        break;
+    }
 
-        if (p->head_x >= 0 && p->head_x < g->width && p->head_y >= 0 && p->head_y < g->height)
-            out[p->head_y * g->width + p->head_x] = '@';
+    case MSG_NEW_GAME: {
+        // nová hra už neprepisuje cudziu, dostane vlastnú miestnosť
+        room_t *r = room_create(S, m->args[3], m->args[4], (GameMode)m->args[0], m->args[2], (WorldType)m->args[1],
+                                m->args[5], (TickMode)m->args[6]);
+        if (!r || client_enter_room(S, cidx, r) < 0) {
+            if (r) room_destroy(S, r);
+            client_reply(c, MSG_ROOM_ERR, 0);
+        }
+        break;
     }
 
-    out[k] = '\0';
-}
+    case MSG_ROOM_LIST:
+        send_room_list(S, c);
+        break;
 
-void send_game_state(server_ctx_t* S, int client_socket) {
-    pthread_mutex_lock(&S->mtx);
+    case MSG_JOIN_GAME: {
+        room_t *r = find_room(S, m->game_id);
+        if (!r || client_enter_room(S, cidx, r) < 0) {
+            client_reply(c, MSG_ROOM_ERR, m->game_id);
+        }
+        break;
+    }
 
-    char response[8192];
-    int off = 0;
+    case MSG_PLAYER_NAME: {
+        // ak klient pošle PLAYER bez miestnosti, ide do najstaršej (alebo default init)
+        if (!c->room) {
+            room_t *r = NULL;
+            for (int i = 0; i < S->num_rooms; i++) {
+                if (!r || S->rooms[i]->id < r->id) r = S->rooms[i];
+            }
+            if (!r) r = room_create(S, DEFAULT_MAP_SIZE, DEFAULT_MAP_SIZE, MODE_TIMED, 365 * 24 * 3600, WORLD_NO_OBSTACLES, 0,
+                                    TICK_SEQUENTIAL);
+            if (!r || client_enter_room(S, cidx, r) < 0) {
+                client_reply(c, MSG_ROOM_ERR, 0);
+                break;
+            }
+        }
 
-    GameState * g = &S->game;
+        room_t *r = c->room;
+        room_lock(S, r);
 
-    off += snprintf(response + off, (int)sizeof(response) - off,
-        "STATE|%d|%d|%d|%d|%d|%d|%d|%d|%d|%d|%d|%d|",
-        g->id,
-        g->width,
-        g->height,
-        g->num_players,
-        g->fruit_x,
-        g->fruit_y,
-        g->active,
-        g->game_over,
-        g->num_obstacles,
-        g->mode,
-        g->world_type,
-        g->elapsed_time
-    );
+        if (c->player_id < 0 && room_count_players(r, S) >= S->max_players) {
+            pthread_mutex_unlock(&r->mtx);
+            client_reply(c, MSG_SERVER_FULL, 0);
+            fprintf(stderr, "[SERVER] Hráč odmietnutý, miestnosť %d je plná (max. hráčov: %d)\n",
+                    r->id, S->max_players);
+            return -1;
+        }
 
-    // ---------- MAPA (VŽDY) ----------
-    char mapbuf[WORLD_WIDTH * WORLD_HEIGHT + 1];
-    build_map(g, mapbuf);
+        // QUIT pred novým PLAYER musí hadíka zabiť skôr, než sa slot použije znova
+        if (c->player_id >= 0 && c->player_id < r->inbox_cap) room_take_quit(r, c->player_id);
+
+        int assigned = -1;
+        int slot = room_pick_slot(S, r, c);
+        if (slot >= 0 && slot < r->game.num_players && player_alive(&r->game, slot)) {
+            // vlastný hadík ešte žije, PLAYER len znova potvrdí id
+            assigned = slot;
+        } else if (slot >= 0 && inbox_reserve(r, slot + 1) == 0) {
+            // vstupy predošlého majiteľa slotu sa novému hadíkovi nepoužijú
+            inbox_t *b = &r->inbox[slot];
+            __atomic_store_n(&b->head, b->tail, __ATOMIC_RELEASE);
+            __atomic_store_n(&b->quit, 0, __ATOMIC_RELAXED);
+            assigned = init_snake(&r->game, slot, m->data);
+            if (assigned >= 0) journal_join(r->journal, assigned, m->data);
+        }
+        c->player_id = assigned;
+        pthread_mutex_unlock(&r->mtx);
+        room_poke(S, r);
 
-    off += snprintf(response + off, (int)sizeof(response) - off,
-        "M|%s|", mapbuf);
+        if (assigned >= 0) client_reply(c, MSG_ASSIGN, assigned);
+        break;
+    }
 
-    // ---------- PREKÁŽKY ----------
-    for (int i = 0; i < g->num_obstacles; i++) {
-        if (off > (int)sizeof(response) - 64) break;
-        off += snprintf(response + off, (int)sizeof(response) - off,
-            "O|%d|%d|",
-            g->obstacles[i][0],
-            g->obstacles[i][1]
-        );
+    case MSG_MOVE: {
+        // nečaká na tick ani na rozosielanie: smer ide do schránky hráča, tick si ho vyberie;
+        // smer ide do 3 bitov pflags, iné hodnoty sa zahodia
+        room_t *r = c->room;
+        int pid = c->player_id;
+        if (!r || pid < 0 || pid >= r->inbox_cap || (unsigned)m->direction > NONE) break;
+        if (inbox_push(&r->inbox[pid], m->direction, m->input_seq) < 0) metrics_add(&r->inputs_dropped, 1);
+        break;
     }
 
-    // ---------- HRÁČI ----------
-    for (int i = 0; i < g->num_players; i++) {
-        if (off > (int)sizeof(response) - 256) break;
-        Player *p = &g->players[i];
-        off += snprintf(response + off, (int)sizeof(response) - off,
-            "P|%d|%s|%d|%d|%d|%d|%d|%d|",
-            p->id,
-            p->name,
-            p->alive,
-            p->score,
-            p->head_x,
-            p->head_y,
-            p->body_len,
-            p->direction
-        );
+    case MSG_QUIT: {
+        room_t *r = c->room;
+        int pid = c->player_id;
+        if (!r || pid < 0 || pid >= r->inbox_cap) break;
+        __atomic_store_n(&r->inbox[pid].quit, 1, __ATOMIC_RELEASE);
+        break;
     }
 
-    // ---------- KONIEC RIADKU ----------
-    if (off < (int)sizeof(response) - 2) {
-        response[off++] = '\n';
-        response[off] = '\0';
-    } else {
-        response[sizeof(response) - 2] = '\n';
-        response[sizeof(response) - 1] = '\0';
-        off = (int)sizeof(response) - 1;
+    default:
+        break;
     }
 
-    pthread_mutex_unlock(&S->mtx);
+    return 0;
+}
+
+static void close_client(server_ctx_t *S, int cidx) {
+    Client *c = &S->clients[cidx];
+    if (!c->in_use) return;
+
+    // zabi hráča (ak bol priradený) a odíď z miestnosti
+    room_leave(S, cidx);
+
+    epoll_ctl(S->epfd, EPOLL_CTL_DEL, c->socket, NULL);
+    close(c->socket);
+
+    // odregistruj klienta
+    pthread_mutex_lock(&c->out_mtx);
+    client_drop_queue(c);
+    free(c->outq);
+    c->outq = NULL;
+    pthread_mutex_unlock(&c->out_mtx);
+
+    free(c->in);
+    c->in = NULL;
+    c->in_len = 0;
+    c->binary = 0;
+
+    c->want_write = 0;
+    __atomic_store_n(&c->kick, 0, __ATOMIC_RELEASE);
+    c->in_use = 0;
+    c->socket = -1;
+    c->player_id = -1;
+    if (S->num_clients > 0) __atomic_store_n(&S->num_clients, S->num_clients - 1, __ATOMIC_RELAXED);
 
-    send(client_socket, response, (size_t)off, 0);
+    fprintf(stderr, "[SERVER] Klient odpojený, aktívni klienti: %d\n", S->num_clients);
 }
-static void* game_loop(void *arg) {
-    server_ctx_t *S = (server_ctx_t*)arg;
 
-    while (S->running) {
-        int sockets[MAX_CLIENTS];
-        int sock_count = 0;
-
-        pthread_mutex_lock(&S->mtx);
-
-        if (S->game.active && S->game.num_players > 0 && !S->game.game_over) {
-            S->game.elapsed_time = (int)(time(NULL) - S->game.start_time);
-
-            if (S->game.mode == MODE_TIMED && S->game.elapsed_time >= S->game.time_limit) {
-                S->game.active = 0;
-                S->game.game_over = 1;
-                fprintf(stderr, "[SERVER] Čas vypršal! KONIEC HRY!\n");
-            } else {
-                for (int i = 0; i < S->game.num_players; i++) {
-                    if (S->game.players[i].alive) {
-                        update_snake(&S->game, &S->game.players[i]);
-                    }
-                }
-            }
+static void accept_clients(server_ctx_t *S, int server_sock) {
+    while (1) {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        int client_socket = accept(server_sock, (struct sockaddr*)&client_addr, &client_len);
+        if (client_socket < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN - všetky čakajúce spojenia sú prijaté
         }
 
-        for (int i = 0; i < MAX_CLIENTS; i++) {
-            if (S->clients[i].in_use) sockets[sock_count++] = S->clients[i].socket;
+        set_nonblocking(client_socket);
+
+        int idx = -1;
+        for (int i = 0; i < MAX_CONNECTIONS; i++) {
+            if (!S->clients[i].in_use) { idx = i; break; }
         }
 
-        pthread_mutex_unlock(&S->mtx);
+        frame_t **outq = (idx >= 0) ? (frame_t**)calloc(OUT_QUEUE_LEN, sizeof(frame_t*)) : NULL;
+        char *in = outq ? (char*)malloc(IN_BUF_SIZE) : NULL;
+        if (!in) {
+            free(outq);
+            const char *full_msg = "SERVER_FULL\n";
+            (void)send(client_socket, full_msg, strlen(full_msg), MSG_DONTWAIT | MSG_NOSIGNAL);
+            close(client_socket);
+            fprintf(stderr, "[SERVER] Pripojenie odmietnuté, MAX_CONNECTIONS=%d\n", MAX_CONNECTIONS);
+            continue;
+        }
+
+        Client *c = &S->clients[idx];
+        c->socket = client_socket;
+        c->in_use = 1;
+        c->player_id = -1;
+        c->room = NULL;
+        c->binary = 0;
+        c->view_w = 0;
+        c->view_h = 0;
+        c->have_view = 0;
+        c->in = in;
+        c->in_len = 0;
+        pthread_mutex_lock(&c->out_mtx);
+        c->outq = outq;
+        c->out_head = 0;
+        c->out_count = 0;
+        c->out_off = 0;
+        c->out_bytes = 0;
+        pthread_mutex_unlock(&c->out_mtx);
+        c->want_write = 0;
+        __atomic_store_n(&c->bytes_sent, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->frames_sent, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->frames_dropped, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&S->num_clients, S->num_clients + 1, __ATOMIC_RELAXED);
+        metrics_add(&S->metrics.connections, 1);
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)idx;
+        epoll_ctl(S->epfd, EPOLL_CTL_ADD, client_socket, &ev);
+
+        fprintf(stderr, "[SERVER] Klient #%d sa pripojil: %s:%d (aktívni: %d)\n",
+                idx, inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port), S->num_clients);
+    }
+}
 
-        for (int i = 0; i < sock_count; i++) {
-            send_game_state(S, sockets[i]);
+// binárne rámce z c->in, vráti -1 pri chybe protokolu alebo zatvorení
+// spracuje všetky celé príkazy v c->in; po HELLO sa formát mení uprostred buffra
+static int process_input(server_ctx_t *S, int cidx) {
+    Client *c = &S->clients[cidx];
+    int pos = 0, rc = 0;
+
+    while (rc == 0) {
+        const char *cmd = c->in + pos;
+        int avail = c->in_len - pos;
+        int used, parsed;
+        Message m;
+
+        if (c->binary) {
+            MessageType type;
+            int plen;
+            int ok = proto_frame_peek((const uint8_t*)cmd, avail, &type, &plen);
+            if (ok == 0) break;
+            if (ok < 0 || PROTO_HEADER_SIZE + plen > IN_BUF_SIZE) return -1;
+            used = PROTO_HEADER_SIZE + plen;
+            parsed = proto_decode_cmd(type, (const uint8_t*)cmd + PROTO_HEADER_SIZE, plen, &m);
+        } else {
+            used = proto_text_frame(cmd, avail);
+            if (used == 0) {
+                // riadok dlhší než celý buffer sa už nikdy neukončí
+                if (avail >= IN_BUF_SIZE) return -1;
+                break;
+            }
+            parsed = proto_parse_cmd_text(cmd, used, &m);
         }
 
-        sleep_us(1000000L / FPS);
+        pos += used;
+        if (parsed == 0) rc = handle_command(S, cidx, &m);
     }
 
-    return NULL;
+    if (pos > 0) {
+        c->in_len -= pos;
+        memmove(c->in, c->in + pos, (size_t)c->in_len);
+    }
+    return rc;
 }
 
-static int find_client_index_by_socket(server_ctx_t *S, int s) {
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (S->clients[i].in_use && S->clients[i].socket == s) return i;
+static void client_readable(server_ctx_t *S, int cidx) {
+    Client *c = &S->clients[cidx];
+
+    while (1) {
+        // v jednom čítaní môže byť viac príkazov aj kus ďalšieho, zvyšok čaká v c->in
+        ssize_t n = recv(c->socket, c->in + c->in_len, (size_t)(IN_BUF_SIZE - c->in_len), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+        int rc = -1;
+        if (n > 0) {
+            c->in_len += (int)n;
+            rc = process_input(S, cidx);
+        }
+        if (rc == 0 && client_flush(S, cidx) < 0) rc = -1;
+
+        if (rc < 0) {
+            // SERVER_FULL a pod. ešte skús doručiť
+            (void)client_flush(S, cidx);
+            close_client(S, cidx);
+            return;
+        }
     }
-    return -1;
 }
 
-typedef struct {
-    server_ctx_t *S;
-    int client_socket;
-} handler_arg_t;
-
-static void* client_handler(void *arg) {
-    handler_arg_t *H = (handler_arg_t*)arg;
-    server_ctx_t *S = H->S;
-    int client_socket = H->client_socket;
-    free(H);
+static void flush_all_clients(server_ctx_t *S) {
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (S->clients[i].in_use && __atomic_load_n(&S->clients[i].kick, __ATOMIC_ACQUIRE)) {
+            fprintf(stderr, "[SERVER] Klient #%d nestíha prijímať, odpája sa\n", i);
+            metrics_add(&S->metrics.clients_kicked, 1);
+            close_client(S, i);
+            continue;
+        }
+        if (S->clients[i].in_use && !S->clients[i].want_write) {
+            if (client_flush(S, i) < 0) close_client(S, i);
+        }
+    }
+}
 
-    char buffer[BUFFER_SIZE];
+static void reactor_run(server_ctx_t *S, int server_sock) {
+    struct epoll_event events[MAX_EVENTS];
 
     while (S->running) {
-        int n = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-        if (n <= 0) break;
-        buffer[n] = '\0';
-
-        pthread_mutex_lock(&S->mtx);
+        int n = epoll_wait(S->epfd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
 
-          int cidx = find_client_index_by_socket(S, client_socket);
-        
-        if (strncmp(buffer, "NEW_GAME", 8) == 0) {
-            int mode, world_type, time_limit, w, h;
- 
-            int nparsed = sscanf(buffer, "NEW_GAME|%d|%d|%d|%d|%d", &mode, &world_type, &time_limit, &w, &h);
-            
-            if (nparsed == 5) {
-                init_game(&S->game, w, h, (GameMode)mode, time_limit, (WorldType)world_type);
-            }
-        } else if (strncmp(buffer, "PLAYER", 6) == 0) {
-            // ak klient pošle PLAYER bez NEW_GAME, sprav default init
-            if (S->game.width <= 0 || S->game.height <= 0) {
-                init_game(&S->game, WORLD_WIDTH, WORLD_HEIGHT, MODE_TIMED, 365 * 24 * 3600, WORLD_NO_OBSTACLES);
+        for (int i = 0; i < n; i++) {
+            uint32_t tag = events[i].data.u32;
+
+            if (tag == TAG_LISTEN) {
+                accept_clients(S, server_sock);
+            } else if (tag == TAG_WAKE) {
+                uint64_t cnt;
+                (void)read(S->wake_fd, &cnt, sizeof(cnt));
+                flush_all_clients(S);
+            } else if (tag < MAX_CONNECTIONS && S->clients[tag].in_use) {
+                int idx = (int)tag;
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    client_readable(S, idx);
+                }
+                if ((events[i].events & EPOLLOUT) && S->clients[idx].in_use) {
+                    if (client_flush(S, idx) < 0) close_client(S, idx);
+                }
             }
+        }
+    }
+}
 
-            char name[50];
-            sscanf(buffer, "PLAYER|%49[^|]", name);
-
-            int assigned = init_snake(&S->game, S->game.num_players, name);
-            if (cidx >= 0) S->clients[cidx].player_id = assigned;
+// ---------- ADMIN SOCKET (telemetria) ----------
 
-            if (assigned >= 0) {
-                char msg[64];
-                snprintf(msg, sizeof(msg), "ASSIGN|%d|\n", assigned);
-                (void)send(client_socket, msg, strlen(msg), 0);
-            }
+#define ADMIN_TIMEOUT_MS 500    // na požiadavku aj odoslanie, pomalý zberač nesmie admin zablokovať
 
-        } else if (strncmp(buffer, "MOVE", 4) == 0) {
-            int pid_from_client, dir;
-            sscanf(buffer, "MOVE|%d|%d", &pid_from_client, &dir);
+typedef struct {
+    int idx;
+    uint64_t bytes_sent;
+    uint64_t frames_sent;
+    uint64_t frames_dropped;
+    int out_count;
+    int out_bytes;
+} client_snap_t;
 
-            int pid = (cidx >= 0) ? S->clients[cidx].player_id : -1;
-            if (pid >= 0 && pid < S->game.num_players && S->game.players[pid].alive) {
-                S->game.players[pid].next_direction = (Direction)dir;
-            }
+typedef struct {
+    int id;
+    size_t memory;
+    int players;
+    int members;
+    int tick_rate;
+    unsigned long overruns;
+    unsigned long skipped;
+    uint64_t inputs_dropped;
+} room_snap_t;
+
+static int snap_clients(server_ctx_t *S, client_snap_t *out) {
+    int n = 0;
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        Client *c = &S->clients[i];
+        // outq je pod out_mtx a existuje práve kým je spojenie otvorené
+        pthread_mutex_lock(&c->out_mtx);
+        if (c->outq) {
+            client_snap_t *cs = &out[n++];
+            cs->idx = i;
+            cs->bytes_sent = metrics_get(&c->bytes_sent);
+            cs->frames_sent = metrics_get(&c->frames_sent);
+            cs->frames_dropped = metrics_get(&c->frames_dropped);
+            cs->out_count = c->out_count;
+            cs->out_bytes = c->out_bytes;
+        }
+        pthread_mutex_unlock(&c->out_mtx);
+    }
+    return n;
+}
 
-        } else if (strncmp(buffer, "QUIT", 4) == 0) {
-            int pid = (cidx >= 0) ? S->clients[cidx].player_id : -1;
-            if (pid >= 0 && pid < S->game.num_players) {
-                S->game.players[pid].alive = 0;
-                ensure_fruits_count(&S->game);
-            }
+// miestnosti sa berú zo zoznamov workerov (rooms[] patrí reaktoru), poradie zámkov ako vo workeri
+static int snap_rooms(server_ctx_t *S, room_snap_t **out, int *cap) {
+    int n = 0;
+    for (int w = 0; w < S->num_workers; w++) {
+        tick_worker_t *W = &S->workers[w];
+        pthread_mutex_lock(&W->mtx);
+        if (grow_array((void**)out, cap, n + W->num_rooms, sizeof(room_snap_t)) < 0) {
+            pthread_mutex_unlock(&W->mtx);
+            return -1;
+        }
+        for (int k = 0; k < W->num_rooms; k++) {
+            room_t *r = W->rooms[k];
+            room_snap_t *rs = &(*out)[n++];
+            pthread_mutex_lock(&r->mtx);
+            rs->id = r->id;
+            rs->memory = game_memory(&r->game);
+            rs->players = room_count_players(r, S);
+            rs->members = r->num_members;
+            rs->tick_rate = r->game.tick_rate;
+            rs->overruns = r->overruns;
+            rs->skipped = r->skipped;
+            rs->inputs_dropped = metrics_get(&r->inputs_dropped);
+            pthread_mutex_unlock(&r->mtx);
         }
+        pthread_mutex_unlock(&W->mtx);
+    }
+    return n;
+}
 
-        pthread_mutex_unlock(&S->mtx);
+static void admin_render(server_ctx_t *S, mtext_t *t) {
+    server_metrics_t *M = &S->metrics;
+    char labels[32];
+
+    static const struct {
+        const char *name;
+        const char *help;
+        size_t off;
+    } times[] = {
+        { "snake_tick_seconds", "Ticky miestnosti a rozoslanie stavu pod jej mutexom.", offsetof(server_metrics_t, tick_ns) },
+        { "snake_simulate_seconds", "Vstupy hráčov a game_tick jedného ticku.", offsetof(server_metrics_t, simulate_ns) },
+        { "snake_encode_seconds", "Jedno zakódovanie stavu alebo výrezu.", offsetof(server_metrics_t, encode_ns) },
+        { "snake_send_seconds", "Jeden sendmsg v reaktore.", offsetof(server_metrics_t, send_ns) },
+        { "snake_room_lock_wait_seconds", "Čakanie na mutex miestnosti (workeri aj reaktor).", offsetof(server_metrics_t, lock_wait_ns) },
+    };
+    for (int i = 0; i < (int)(sizeof(times) / sizeof(times[0])); i++) {
+        metrics_header(t, times[i].name, "histogram", times[i].help);
+        metrics_hist(t, times[i].name, NULL, (const metrics_hist_t*)((const char*)M + times[i].off), METRICS_NS_LO, 1e9);
+    }
+    metrics_header(t, "snake_send_queue_frames", "histogram", "Rámcov vo fronte spojenia po zaradení stavu.");
+    metrics_hist(t, "snake_send_queue_frames", NULL, &M->queue_depth, 0, 1);
+
+    metrics_header(t, "snake_sent_bytes_total", "counter", "Odoslané bajty všetkým klientom.");
+    metrics_value(t, "snake_sent_bytes_total", NULL, (double)metrics_get(&M->bytes_sent));
+    metrics_header(t, "snake_sent_frames_total", "counter", "Celé odoslané rámce.");
+    metrics_value(t, "snake_sent_frames_total", NULL, (double)metrics_get(&M->frames_sent));
+    metrics_header(t, "snake_dropped_frames_total", "counter", "Stavy, ktoré klient nedostal, podľa príčiny.");
+    for (int i = 0; i < DROP_COUNT; i++) {
+        snprintf(labels, sizeof(labels), "reason=\"%s\"", drop_reason_names[i]);
+        metrics_value(t, "snake_dropped_frames_total", labels, (double)metrics_get(&M->frames_dropped[i]));
+    }
+    metrics_header(t, "snake_kicked_clients_total", "counter", "Klienti odpojení pre pomalé prijímanie.");
+    metrics_value(t, "snake_kicked_clients_total", NULL, (double)metrics_get(&M->clients_kicked));
+    metrics_header(t, "snake_connections_total", "counter", "Prijaté spojenia.");
+    metrics_value(t, "snake_connections_total", NULL, (double)metrics_get(&M->connections));
+    metrics_header(t, "snake_clients", "gauge", "Pripojení klienti.");
+    metrics_value(t, "snake_clients", NULL, __atomic_load_n(&S->num_clients, __ATOMIC_RELAXED));
+    metrics_header(t, "snake_tick_workers", "gauge", "Vlákna tickov.");
+    metrics_value(t, "snake_tick_workers", NULL, S->num_workers);
+    metrics_header(t, "snake_pool_threads", "gauge", "Pomocné vlákna dvojfázového ticku.");
+    metrics_value(t, "snake_pool_threads", NULL, pool_threads(S->pool));
+
+    // ---------- SPOJENIA ----------
+    client_snap_t *cs = (client_snap_t*)malloc(MAX_CONNECTIONS * sizeof(client_snap_t));
+    int nc = cs ? snap_clients(S, cs) : 0;
+    static const struct {
+        const char *name;
+        const char *type;
+        const char *help;
+    } cm[] = {
+        { "snake_client_sent_bytes_total", "counter", "Odoslané bajty spojeniu." },
+        { "snake_client_sent_frames_total", "counter", "Celé odoslané rámce spojeniu." },
+        { "snake_client_dropped_frames_total", "counter", "Stavy, ktoré spojenie nedostalo." },
+        { "snake_client_queue_frames", "gauge", "Rámce čakajúce vo fronte spojenia." },
+        { "snake_client_queue_bytes", "gauge", "Neodoslané bajty vo fronte spojenia." },
+    };
+    for (int m = 0; m < (int)(sizeof(cm) / sizeof(cm[0])); m++) {
+        metrics_header(t, cm[m].name, cm[m].type, cm[m].help);
+        for (int i = 0; i < nc; i++) {
+            double v = (m == 0) ? (double)cs[i].bytes_sent
+                     : (m == 1) ? (double)cs[i].frames_sent
+                     : (m == 2) ? (double)cs[i].frames_dropped
+                     : (m == 3) ? cs[i].out_count
+                                : cs[i].out_bytes;
+            snprintf(labels, sizeof(labels), "client=\"%d\"", cs[i].idx);
+            metrics_value(t, cm[m].name, labels, v);
+        }
+    }
+    free(cs);
+
+    // ---------- MIESTNOSTI ----------
+    room_snap_t *rs = NULL;
+    int rcap = 0;
+    int nr = snap_rooms(S, &rs, &rcap);
+    if (nr < 0) nr = 0;
+    metrics_header(t, "snake_rooms", "gauge", "Miestnosti.");
+    metrics_value(t, "snake_rooms", NULL, nr);
+    static const struct {
+        const char *name;
+        const char *type;
+        const char *help;
+    } rm[] = {
+        { "snake_room_memory_bytes", "gauge", "Pamäť stavu hry miestnosti (game_memory)." },
+        { "snake_room_players", "gauge", "Hráči v miestnosti." },
+        { "snake_room_members", "gauge", "Spojenia v miestnosti (hráči aj diváci)." },
+        { "snake_room_tick_rate", "gauge", "Tickov za sekundu." },
+        { "snake_room_overruns_total", "counter", "Koľkokrát miestnosť dobiehala zmeškané ticky." },
+        { "snake_room_skipped_ticks_total", "counter", "Vynechané ticky." },
+        { "snake_room_dropped_inputs_total", "counter", "MOVE, ktoré sa nezmestili do schránky hráča." },
+    };
+    for (int m = 0; m < (int)(sizeof(rm) / sizeof(rm[0])); m++) {
+        metrics_header(t, rm[m].name, rm[m].type, rm[m].help);
+        for (int i = 0; i < nr; i++) {
+            double v = (m == 0) ? (double)rs[i].memory
+                     : (m == 1) ? rs[i].players
+                     : (m == 2) ? rs[i].members
+                     : (m == 3) ? rs[i].tick_rate
+                     : (m == 4) ? (double)rs[i].overruns
+                     : (m == 5) ? (double)rs[i].skipped
+                                : (double)rs[i].inputs_dropped;
+            snprintf(labels, sizeof(labels), "room=\"%d\"", rs[i].id);
+            metrics_value(t, rm[m].name, labels, v);
+        }
     }
+    free(rs);
+}
 
-    close(client_socket);
+static int send_all(int fd, const char *buf, int len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, (size_t)len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        buf += n;
+        len -= (int)n;
+    }
+    return 0;
+}
 
+// jedna požiadavka: HTTP GET (Prometheus, curl) dostane hlavičku, čokoľvek iné (nc) len text
+static void admin_serve(server_ctx_t *S, int fd) {
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = ADMIN_TIMEOUT_MS * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    char req[1024];
+    ssize_t n = recv(fd, req, sizeof(req), 0);
+    int http = (n >= 4 && memcmp(req, "GET ", 4) == 0);
+
+    mtext_t body;
+    mtext_init(&body);
+    admin_render(S, &body);
+
+    if (http) {
+        char hdr[160];
+        int hl = body.err
+            ? snprintf(hdr, sizeof(hdr), "HTTP/1.0 500 Internal Server Error\r\nConnection: close\r\n\r\n")
+            : snprintf(hdr, sizeof(hdr), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                         "Content-Length: %d\r\nConnection: close\r\n\r\n", body.len);
+        if (send_all(fd, hdr, hl) < 0) body.err = 1;
+    }
+    if (!body.err) (void)send_all(fd, body.buf, body.len);
+    mtext_free(&body);
+}
 
-    pthread_mutex_lock(&S->mtx);
- 
-    int cidx = find_client_index_by_socket(S, client_socket);
-    if (cidx >= 0) {
-        int pid = S->clients[cidx].player_id;
- 
-        // odregistruj klienta
-        S->clients[cidx].in_use = 0;
-        S->clients[cidx].socket = -1;
-        S->clients[cidx].player_id = -1;
-        if (S->num_clients > 0) S->num_clients--;
- 
-        // zabi hráča (ak bol priradený)
-        if (pid >= 0 && pid < S->game.num_players) {
-            S->game.players[pid].alive = 0;
-            ensure_fruits_count(&S->game);
+// vlastné vlákno, aby zber nebrzdil reaktor; končí, keď main zavrie admin_sock
+static void* admin_loop(void *arg) {
+    server_ctx_t *S = (server_ctx_t*)arg;
+    for (;;) {
+        int fd = accept(S->admin_sock, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
         }
-    } 
+        admin_serve(S, fd);
+        close(fd);
+    }
+    return NULL;
+}
 
-    pthread_mutex_unlock(&S->mtx);
+// len na loopback: telemetria nie je pre hráčov
+static int admin_listen(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
 
-    fprintf(stderr, "[SERVER] Klient odpojený, aktívni klienti: %d\n", S->num_clients);
-    return NULL;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+typedef struct {
+    int num_workers;
+    int keyframe_interval;
+    SlowPolicy slow_policy;
+    int tick_rate;
+    int max_players;
+    int view_size;
+    int pool_threads;
+    const char *journal_dir;
+    int admin_port;         // 0 = bez admin socketu
+} server_opts_t;
+
+static const char *slow_policy_names[] = { "latest", "throttle", "kick" };
+
+static int parse_options(int argc, char **argv, server_opts_t *o) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    o->num_workers = (n > 0) ? (int)n : 1;
+    o->keyframe_interval = 5 * FPS;
+    o->slow_policy = SLOW_LATEST;
+    o->tick_rate = FPS;
+    o->max_players = DEFAULT_MAX_PLAYERS;
+    o->view_size = DEFAULT_VIEW;
+    o->pool_threads = 0;
+    o->journal_dir = NULL;
+    o->admin_port = 0;
+
+    // za portom nasledujú voliteľné prepínače
+    optind = 2;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:k:s:t:p:v:j:J:a:")) != -1) {
+        switch (opt) {
+            case 'w': o->num_workers = atoi(optarg); break;
+            case 'k': o->keyframe_interval = atoi(optarg); break;
+            case 't': o->tick_rate = atoi(optarg); break;
+            case 'p': o->max_players = atoi(optarg); break;
+            case 'v': o->view_size = atoi(optarg); break;
+            case 'j': o->pool_threads = atoi(optarg); break;
+            case 'J': o->journal_dir = optarg; break;
+            case 'a': o->admin_port = atoi(optarg); break;
+            case 's': {
+                int found = 0;
+                for (int i = 0; i < (int)(sizeof(slow_policy_names) / sizeof(slow_policy_names[0])); i++) {
+                    if (strcmp(optarg, slow_policy_names[i]) == 0) {
+                        o->slow_policy = (SlowPolicy)i;
+                        found = 1;
+                    }
+                }
+                if (found) break;
+            }
+            // fallthrough - neznáma politika -> použitie
+            default:
+                fprintf(stderr, "Použitie: %s <port> [-w tick_workerov] [-k interval_kľúčových_stavov (0 = bez delty)]"
+                                " [-s latest|throttle|kick] [-t tickov_za_sekundu]"
+                                " [-p hráčov_v_miestnosti] [-v strana_výrezu (0 = celá mapa)]"
+                                " [-j vlákien_dvojfázového_ticku] [-J adresár_žurnálov]"
+                                " [-a port_telemetrie (127.0.0.1)]\n", argv[0]);
+                return -1;
+        }
+    }
+
+    if (o->num_workers < 1) o->num_workers = 1;
+    if (o->keyframe_interval < 0) o->keyframe_interval = 0;
+    if (o->tick_rate < MIN_TICK_RATE) o->tick_rate = MIN_TICK_RATE;
+    if (o->tick_rate > MAX_TICK_RATE) o->tick_rate = MAX_TICK_RATE;
+    if (o->max_players < 1) o->max_players = 1;
+    // plná miestnosť na najväčšej mape musí mať kľúčový rámec, ktorý klient ešte prijme
+    int players_cap = proto_max_players(MAX_MAP_SIZE, MAX_MAP_SIZE);
+    if (o->max_players > players_cap) o->max_players = players_cap;
+    if (o->view_size < 0) o->view_size = 0;
+    if (o->view_size > 0 && o->view_size < VIEW_MIN) o->view_size = VIEW_MIN;
+    if (o->view_size > VIEW_MAX) o->view_size = VIEW_MAX;
+    if (o->pool_threads < 0) o->pool_threads = 0;
+    if (o->admin_port < 0 || o->admin_port > 65535) o->admin_port = 0;
+    return 0;
 }
 
 int main(int argc, char **argv) {
     int port = parse_port(argc,argv);
     if (port < 0) return 1;
 
-    fprintf(stderr, "SERVER HADIK - port %d\n", port);
+    server_opts_t opts;
+    if (parse_options(argc, argv, &opts) < 0) return 1;
+    int num_workers = opts.num_workers;
 
+    fprintf(stderr, "SERVER HADIK - port %d, tick workerov: %d, kľúčový stav každých %d tickov, pomalí klienti: %s,"
+                    " hráčov v miestnosti: %d, výrez: %d, vlákien dvojfázového ticku: %d, žurnály: %s,"
+                    " telemetria: port %d\n",
+            port, num_workers, opts.keyframe_interval, slow_policy_names[opts.slow_policy], opts.max_players,
+            opts.view_size, opts.pool_threads, opts.journal_dir ? opts.journal_dir : "vypnuté", opts.admin_port);
 
-    srand((unsigned)time(NULL));
 
-    server_ctx_t S;
-    memset(&S, 0, sizeof(S));
-    pthread_mutex_init(&S.mtx, NULL);
-    S.running = 1;
 
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        S.clients[i].socket = -1;
-        S.clients[i].in_use = 0;
-        S.clients[i].player_id = -1;
+    // server_ctx_t je veľký, na stack sa nezmestí
+    server_ctx_t *S = (server_ctx_t*)calloc(1, sizeof(server_ctx_t));
+    if (!S) {
+        perror("calloc");
+        return 1;
+    }
+    S->running = 1;
+    S->next_room_id = 1;
+    S->keyframe_interval = opts.keyframe_interval;
+    S->slow_policy = opts.slow_policy;
+    S->tick_rate = opts.tick_rate;
+    S->max_players = opts.max_players;
+    S->view_size = opts.view_size;
+    S->journal_dir = opts.journal_dir;
+    S->admin_sock = -1;
+    if (opts.pool_threads > 0) {
+        S->pool = pool_create(opts.pool_threads);
+        if (!S->pool) fprintf(stderr, "[SERVER] Pool vlákien sa nepodarilo vytvoriť, fáza zámerov pôjde vo workeroch\n");
     }
 
-  
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        S->clients[i].socket = -1;
+        S->clients[i].in_use = 0;
+        S->clients[i].player_id = -1;
+        pthread_mutex_init(&S->clients[i].out_mtx, NULL);
+    }
 
     int server_sock = socket(AF_INET, SOCK_STREAM, 0);
     if (server_sock < 0) {
@@ -623,71 +1820,76 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    if (listen(server_sock, MAX_CLIENTS) < 0) {
+    if (listen(server_sock, SOMAXCONN) < 0) {
         perror("listen");
         close(server_sock);
         return 1;
     }
+    set_nonblocking(server_sock);
 
-    fprintf(stderr, "[SERVER] Čaká sa na klientov...\n");
-
-    pthread_t game_thread;
-    pthread_create(&game_thread, NULL, game_loop, &S);
-
-    while (S.running) {
-        struct sockaddr_in client_addr;
-        socklen_t client_len = sizeof(client_addr);
-        int client_socket = accept(server_sock, (struct sockaddr*)&client_addr, &client_len);
-        if (client_socket < 0) continue;
+    S->epfd = epoll_create1(0);
+    S->wake_fd = eventfd(0, EFD_NONBLOCK);
+    if (S->epfd < 0 || S->wake_fd < 0) {
+        perror("epoll/eventfd");
+        close(server_sock);
+        return 1;
+    }
 
-        pthread_mutex_lock(&S.mtx);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = TAG_LISTEN;
+    epoll_ctl(S->epfd, EPOLL_CTL_ADD, server_sock, &ev);
+    ev.data.u32 = TAG_WAKE;
+    epoll_ctl(S->epfd, EPOLL_CTL_ADD, S->wake_fd, &ev);
 
-        if (S.num_clients >= MAX_CLIENTS) {
-            const char *full_msg = "SERVER_FULL\n";
-            (void)send(client_socket, full_msg, strlen(full_msg), 0);
-            close(client_socket);
-            pthread_mutex_unlock(&S.mtx);
-            fprintf(stderr, "[SERVER] Pripojenie odmietnuté, MAX_CLIENTS=%d\n", MAX_CLIENTS);
-            continue;
-        }
+    fprintf(stderr, "[SERVER] Čaká sa na klientov...\n");
 
-        int idx = -1;
-        for (int i = 0; i < MAX_CLIENTS; i++) {
-            if (!S.clients[i].in_use) { idx = i; break; }
-        }
+    // termíny tickov sú na monotónnych hodinách
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+
+    S->num_workers = num_workers;
+    S->workers = (tick_worker_t*)calloc((size_t)num_workers, sizeof(tick_worker_t));
+    for (int i = 0; i < num_workers; i++) {
+        S->workers[i].S = S;
+        pthread_mutex_init(&S->workers[i].mtx, NULL);
+        pthread_cond_init(&S->workers[i].cond, &cattr);
+        pthread_create(&S->workers[i].thread, NULL, tick_worker_loop, &S->workers[i]);
+    }
 
-        if (idx == -1) {
-            const char *full_msg = "SERVER_FULL\n";
-            (void)send(client_socket, full_msg, strlen(full_msg), 0);
-            close(client_socket);
-            pthread_mutex_unlock(&S.mtx);
-            continue;
+    // admin socket až po workeroch, zber číta ich zoznamy miestností
+    if (opts.admin_port > 0) {
+        S->admin_sock = admin_listen(opts.admin_port);
+        if (S->admin_sock >= 0 && pthread_create(&S->admin_thread, NULL, admin_loop, S) != 0) {
+            close(S->admin_sock);
+            S->admin_sock = -1;
         }
+        if (S->admin_sock < 0) fprintf(stderr, "[SERVER] Admin socket na porte %d sa nepodarilo otvoriť\n", opts.admin_port);
+        else fprintf(stderr, "[SERVER] Telemetria na 127.0.0.1:%d\n", opts.admin_port);
+    }
 
-        S.clients[idx].socket = client_socket;
-        S.clients[idx].in_use = 1;
-        S.clients[idx].player_id = -1;
-        S.num_clients++;
-
-        fprintf(stderr, "[SERVER] Klient #%d sa pripojil: %s:%d (aktívni: %d)\n",
-                idx, inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port), S.num_clients);
-
-        pthread_mutex_unlock(&S.mtx);
-
-        handler_arg_t *H = (handler_arg_t*)malloc(sizeof(handler_arg_t));
-        H->S = &S;
-        H->client_socket = client_socket;
+    reactor_run(S, server_sock);
 
-        pthread_t thread;
-        pthread_create(&thread, NULL, client_handler, H);
-        pthread_detach(thread);
+    S->running = 0;
+    for (int i = 0; i < num_workers; i++) {
+        pthread_mutex_lock(&S->workers[i].mtx);
+        pthread_cond_signal(&S->workers[i].cond);
+        pthread_mutex_unlock(&S->workers[i].mtx);
+        pthread_join(S->workers[i].thread, NULL);
     }
-
-    S.running = 0;
-    pthread_join(game_thread, NULL);
+    if (S->admin_sock >= 0) {
+        // shutdown zobudí accept v admin vlákne
+        shutdown(S->admin_sock, SHUT_RDWR);
+        pthread_join(S->admin_thread, NULL);
+        close(S->admin_sock);
+    }
+    pool_free(S->pool);
     close(server_sock);
+    close(S->wake_fd);
+    close(S->epfd);
 
-    pthread_mutex_destroy(&S.mtx);
     fprintf(stderr, "[SERVER] Server sa vypína...\n");
     return 0;
 }
@@ -1,6 +1,7 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,20 +17,31 @@
 #define BUFFER_SIZE 8192
 #define DEFAULT_PORT 22346
 
-// max rozmery pre buffre/klienta (kvôli world[][] a mapbuf)
-#define WORLD_WIDTH MAX_MAP_SIZE
-#define WORLD_HEIGHT MAX_MAP_SIZE
- 
-// limity, ktoré bude hráč zadávať
+// limity, ktoré bude hráč zadávať; mriežka sa alokuje podľa skutočných rozmerov
 #define MIN_MAP_SIZE 10
-#define MAX_MAP_SIZE 25
- 
+#define MAX_MAP_SIZE 500        // rozmery idú v protokole ako u16, väčšie rámce by prerástli PROTO_MAX_FRAME
+#define DEFAULT_MAP_SIZE 25
+
+// výrez mapy (area of interest): väčšie mapy dostane binárny klient len okolo svojho hadíka
+#define VIEW_MIN MIN_MAP_SIZE
+#define VIEW_MAX 120
+#define DEFAULT_VIEW 40         // pre klienta, ktorý si veľkosť nevyžiada; server to mení prepínačom -v
 
 #define INITIAL_SNAKE_LEN 3
-#define FPS 5
-#define MAX_OBSTACLES 7
-#define MAX_CLIENTS 4
-#define MAX_FRUITS 10
+#define FPS 5               // predvolený počet tickov za sekundu
+#define MIN_TICK_RATE 1
+#define MAX_TICK_RATE 60
+#define MIN_OBSTACLES 7         // malé mapy majú toľko prekážok
+#define OBSTACLE_CELLS 90       // na väčších jedna prekážka na toľko buniek
+#define DEFAULT_MAX_PLAYERS 4   // hráčov v miestnosti, server to mení prepínačom -p
+#define MAX_PLAYERS 65535       // id hráča ide v protokole ako u16; -p ešte obmedzuje proto_max_players
+
+// obsah bunky v mriežke obsadenosti (rovnaké znaky ako v mape posielanej klientom)
+#define CELL_EMPTY '.'
+#define CELL_OBSTACLE '#'
+#define CELL_FRUIT '*'
+#define CELL_BODY '~'
+#define CELL_HEAD '@'
 
 typedef enum {
     MSG_NEW_GAME = 1,
@@ -41,7 +53,17 @@ typedef enum {
     MSG_JOIN_GAME = 7,
     MSG_PLAYER_NAME = 8,
     MSG_GAME_OVER = 9,
-    MSG_INIT = 10
+    MSG_INIT = 10,
+    MSG_HELLO = 11,
+    MSG_ASSIGN = 12,
+    MSG_ROOM_LIST = 13,
+    MSG_ROOMS = 14,
+    MSG_ROOM = 15,
+    MSG_ROOM_ERR = 16,
+    MSG_SERVER_FULL = 17,
+    MSG_STATE_DELTA = 18,
+    MSG_VIEW = 19,          // klient: veľkosť výrezu mapy, ktorý chce dostávať
+    MSG_VIEW_STATE = 20     // server: stav len vo výreze okolo hadíka
 } MessageType;
 
 typedef enum {
@@ -62,6 +84,12 @@ typedef enum {
     WORLD_WITH_OBSTACLES = 2
 } WorldType;
 
+// ako sa v ticku hýbu hadíky; posiela sa v NEW_GAME, 0 pre starých klientov
+typedef enum {
+    TICK_SEQUENTIAL = 0,    // po poradí hráčov, v zrážke hláv vyhrá ten s menším indexom
+    TICK_TWO_PHASE = 1      // naraz: zámery všetkých (paralelne), potom spoločné vyhodnotenie
+} TickMode;
+
 typedef struct {
     MessageType type;
     int player_id;
@@ -69,41 +97,109 @@ typedef struct {
     int game_id;
     int timestamp;
     char data[256];
+    // číselné parametre (NEW_GAME: mode, world_type, time_limit, width, height, tick_rate, tick_mode)
+    int args[7];
+    unsigned int input_seq;     // MOVE: poradové číslo vstupu, server ho vráti v stave
 } Message;
 
+// bity v GameState.pflags: živý, smer a smer z posledného MOVE (Direction sa zmestí do 3 bitov)
+#define PF_ALIVE 0x01
+#define PF_DIR_SHIFT 1
+#define PF_NEXT_SHIFT 4
+#define PF_DIR_MASK 0x07
+
+// studené dáta hráča, tick ich číta len pri zjedení ovocia a v logoch
 typedef struct {
     int id;
     int score;
-    int alive;
     char name[50];
-    Direction direction;
-    Direction next_direction;
-    int head_x;
-    int head_y;
-    int body_len;
-    int body_x[1000];
-    int body_y[1000];
 } Player;
 
+// kruhový buffer tela, head je index hlavy, chvost je body_len - 1 pozícií za ňou;
+// cap rastie s hadíkom (game.c), klient telá nedostáva
+typedef struct {
+    int head;
+    int cap;
+    uint16_t *x;
+    uint16_t *y;
+} SnakeBody;
+
 typedef struct {
     int id;
     int width;
     int height;
+    // polia sú na heape a *_cap je ich alokovaná veľkosť; prvý init_game dostane vynulovaný stav
     int num_players;
-    Player players[10];
+    int players_cap;
+    // hadíky ako structure-of-arrays, index i patrí i-temu hráčovi; tick a delta prechádzajú
+    // horúce polia lineárne, do players (meno, skóre) sa pozerá len pri zmene
+    uint16_t *head_x;
+    uint16_t *head_y;
+    uint8_t *pflags;            // PF_ALIVE | smer | ďalší smer
+    uint32_t *body_len;
+    uint32_t *next_seq;         // input_seq posledného použitého MOVE
+    uint32_t *input_seq;        // input_seq, ktorý už ticky spracovali (posiela sa klientom)
+    SnakeBody *bodies;          // len simulácia
+    Player *players;
     int fruit_x;
     int fruit_y;
     int num_fruits;
-    int fruits[MAX_FRUITS][2];
-    int obstacles[MAX_OBSTACLES][2];
+    int fruits_cap;
+    int (*fruits)[2];
+    int (*obstacles)[2];
     int num_obstacles;
+    int obstacles_cap;
     GameMode mode;
     WorldType world_type;
     int time_limit;
     int elapsed_time;
     int active;
     int game_over;
-    time_t start_time;
+    int tick_rate;          // tickov za sekundu, elapsed_time sa počíta z tickov
+    TickMode tick_mode;     // vlastnosť miestnosti, init_game ho nemení
+    unsigned int tick;      // ticky od štartu hry
+    uint64_t seed;          // z init_game, podľa neho sa dá hra zopakovať
+    uint64_t rng;           // stav generátora miestnosti (ovocie, prekážky), len simulácia
+    // mriežka obsadenosti, index y * width + x; cells_cap buniek
+    int cells_cap;
+    char *grid;
+    // len simulácia (game.c), dekódovaný stav klienta ich nemá:
+    // voľné bunky: free_cells[0..num_free) a pozícia bunky v ňom (free_pos, -1 = obsadená)
+    int *free_cells;
+    int *free_pos;
+    int num_free;
+    // bunky zmenené od posledného odoslaného stavu (pre delta rámce)
+    int *dirty_cells;
+    char *dirty_mark;
+    int num_dirty;
+    // dvojfázový tick: zámer hadíka (bunka hlavy a čo v nej je) a kto si bunku nárokuje (-1 = nikto)
+    int *next_cell;             // players_cap
+    uint8_t *intent;            // players_cap
+    int *claim;                 // cells_cap
 } GameState;
 
+static inline int player_alive(const GameState *g, int i) {
+    return g->pflags[i] & PF_ALIVE;
+}
+
+static inline Direction player_dir(const GameState *g, int i) {
+    return (Direction)((g->pflags[i] >> PF_DIR_SHIFT) & PF_DIR_MASK);
+}
+
+static inline Direction player_next_dir(const GameState *g, int i) {
+    return (Direction)((g->pflags[i] >> PF_NEXT_SHIFT) & PF_DIR_MASK);
+}
+
+static inline void player_set_alive(GameState *g, int i, int alive) {
+    g->pflags[i] = (uint8_t)((g->pflags[i] & ~PF_ALIVE) | (alive ? PF_ALIVE : 0));
+}
+
+static inline void player_set_dir(GameState *g, int i, Direction d) {
+    g->pflags[i] = (uint8_t)((g->pflags[i] & ~(PF_DIR_MASK << PF_DIR_SHIFT)) | ((unsigned)d << PF_DIR_SHIFT));
+}
+
+static inline void player_set_next_dir(GameState *g, int i, Direction d) {
+    g->pflags[i] = (uint8_t)((g->pflags[i] & ~(PF_DIR_MASK << PF_NEXT_SHIFT)) | ((unsigned)d << PF_NEXT_SHIFT));
+}
+
 #endif